@@ -135,6 +135,8 @@ struct DecltypeAnyUnit
 #include <unordered_set>
 
 #include <filesystem>
+#include <string_view>
+#include <charconv>
 
 #define NOMINMAX
 constexpr size_t ConstexprStrlen(const char* source)
@@ -1332,6 +1334,15 @@ namespace std
 	}
 }
 
+namespace Convention
+{
+	// true when T has a const ToString() member
+	template<typename T, typename = void>
+	struct HasToStringMember : std::false_type {};
+	template<typename T>
+	struct HasToStringMember<T, std::void_t<decltype(std::declval<const T&>().ToString())>> : std::true_type {};
+}
+
 struct CharIndicator
 {
 #if defined(UNICODE)
@@ -1435,6 +1446,68 @@ struct StringIndicator
 			static_assert(std::is_convertible_v<str, T>, "Cannot convert string to the specified type.");
 	}
 
+	// parse the whole of text into value without exceptions or locale, like std::from_chars
+	// a leading '+' is accepted; returns std::errc() on success, invalid_argument for malformed
+	// or partially consumed text, result_out_of_range when the value does not fit T
+	template<typename T>
+	static std::errc TryToValue(std::string_view text, T& value)
+	{
+		if constexpr (std::is_same_v<T, bool>)
+		{
+			if (text == "true")
+				value = true;
+			else if (text == "false")
+				value = false;
+			else
+				return std::errc::invalid_argument;
+			return std::errc();
+		}
+		else if constexpr (std::is_integral_v<T> || std::is_floating_point_v<T>)
+		{
+			const char* first = text.data();
+			const char* last = first + text.size();
+			if (first != last && *first == '+' && last - first > 1 && first[1] != '-')
+				++first;
+			std::from_chars_result result{ first, std::errc::invalid_argument };
+#if !defined(__cpp_lib_to_chars)
+			if constexpr (std::is_floating_point_v<T>)
+			{
+				// no floating from_chars: strtod on a null-terminated copy
+				const std::string copy(first, last);
+				if (copy.empty() || std::isspace(static_cast<unsigned char>(copy.front())))
+					return std::errc::invalid_argument;
+				char* end = nullptr;
+				errno = 0;
+				const T parsed = std::is_same_v<T, float> ? std::strtof(copy.c_str(), &end)
+					: std::is_same_v<T, double> ? std::strtod(copy.c_str(), &end)
+					: std::strtold(copy.c_str(), &end);
+				result.ptr = first + (end - copy.c_str());
+				if (end == copy.c_str())
+					result.ec = std::errc::invalid_argument;
+				else if (errno == ERANGE)
+					result.ec = std::errc::result_out_of_range;
+				else
+				{
+					result.ec = std::errc();
+					value = parsed;
+				}
+			}
+			else
+#endif
+				result = std::from_chars(first, last, value);
+			if (result.ec != std::errc())
+				return result.ec;
+			if (result.ptr != last)
+				return std::errc::invalid_argument;
+			return std::errc();
+		}
+		else
+		{
+			static_assert(std::is_arithmetic_v<T>, "TryToValue supports bool, integral and floating types");
+			return std::errc::invalid_argument;
+		}
+	}
+
 	template<typename str, typename _T>
 	static str Combine(const _T& first)
 	{
@@ -1443,12 +1516,83 @@ struct StringIndicator
 	template<typename str, typename _First, typename _LeftT>
 	static str Combine(const _First& first, const _LeftT& arg)
 	{
-		return ToString<str>(first) + ToString<str>(arg);
+		if constexpr (std::is_same_v<str, std::string>)
+			return CombineReserved(first, arg);
+		else
+			return ToString<str>(first) + ToString<str>(arg);
 	}
 	template<typename str, typename _First, typename... Args>
 	static str Combine(const _First& first, const Args&...args)
 	{
-		return ToString<str>(first) + Combine<str>(args...);
+		if constexpr (std::is_same_v<str, std::string>)
+			return CombineReserved(first, args...);
+		else
+			return ToString<str>(first) + Combine<str>(args...);
+	}
+
+	// space reserved for one CombineReserved argument: exact for strings, a compile-time
+	// upper bound for integers, an estimate for floats; other types are sized while appending
+	template<typename T>
+	static size_t CombineLength(const T& value)
+	{
+		if constexpr (std::is_convertible_v<const T&, std::string_view> && !Convention::HasToStringMember<T>::value)
+			return std::string_view(value).size();
+		else if constexpr (std::is_integral_v<T>)
+			return std::numeric_limits<T>::digits10 + 2;
+		else if constexpr (std::is_floating_point_v<T>)
+			return 32;
+		else
+			return 0;
+	}
+	// copy text to result[size]; reserved is what CombineLength set aside for it
+	static void CombineWrite(std::string& result, size_t& size, size_t reserved, std::string_view text)
+	{
+		if (text.size() > reserved)
+			result.resize(result.size() + text.size() - reserved);
+		std::memcpy(result.data() + size, text.data(), text.size());
+		size += text.size();
+	}
+	// write one argument at result[size], growing result only when it needs more than was reserved
+	template<typename T>
+	static void CombineAppend(std::string& result, size_t& size, const T& value)
+	{
+		if constexpr (std::is_convertible_v<const T&, std::string_view> && !Convention::HasToStringMember<T>::value)
+		{
+			CombineWrite(result, size, CombineLength(value), value);
+		}
+		else if constexpr (std::is_integral_v<T>)
+		{
+			// same digits as std::to_string, written straight into result
+			using wide = std::conditional_t<std::is_signed_v<T>, long long, unsigned long long>;
+			const auto written = std::to_chars(result.data() + size, result.data() + result.size(), static_cast<wide>(value));
+			size = static_cast<size_t>(written.ptr - result.data());
+		}
+		else if constexpr (std::is_floating_point_v<T>)
+		{
+			// same text as std::to_string ("%f"), formatted on the stack
+			char buffer[64];
+			const int length = std::is_same_v<T, long double>
+				? snprintf(buffer, sizeof(buffer), "%Lf", static_cast<long double>(value))
+				: snprintf(buffer, sizeof(buffer), "%f", static_cast<double>(value));
+			if (length >= 0 && static_cast<size_t>(length) < sizeof(buffer))
+				CombineWrite(result, size, CombineLength(value), std::string_view(buffer, static_cast<size_t>(length)));
+			else
+				CombineWrite(result, size, CombineLength(value), ToString<std::string>(value));
+		}
+		else
+		{
+			CombineWrite(result, size, 0, ToString<std::string>(value));
+		}
+	}
+	// Combine into a single string: reserve all arguments at once, then append each in place
+	template<typename... Args>
+	static std::string CombineReserved(const Args&... args)
+	{
+		std::string result((CombineLength(args) + ... + 0), '\0');
+		size_t size = 0;
+		(CombineAppend(result, size, args), ...);
+		result.resize(size);
+		return result;
 	}
 
 	// trim whitespace from the beginning and end of a string
@@ -1501,9 +1645,18 @@ struct StringIndicator
 	template<typename str, typename... Args>
 	static str Format(size_t size, const std::string& format, const Args&... args)
 	{
-		str result;
-		result.reserve(size);
-		snprintf(result.data(), size, format.c_str(), args...);
+		// write into a buffer of the hinted size, then retry once with the exact length if it was short
+		str result(size, '\0');
+		const int length = snprintf(result.data(), size + 1, format.c_str(), args...);
+		if (length < 0)
+			throw std::runtime_error("Format failed: invalid format string");
+		if (static_cast<size_t>(length) > size)
+		{
+			result.assign(static_cast<size_t>(length), '\0');
+			snprintf(result.data(), static_cast<size_t>(length) + 1, format.c_str(), args...);
+		}
+		else
+			result.resize(static_cast<size_t>(length));
 		return result;
 	}
 };
@@ -1521,6 +1674,328 @@ struct StringIndicator
 
 #pragma endregion
 
+#pragma region Format
+
+namespace Convention
+{
+	// one piece of a parsed "{}" format string: literal text or an argument slot
+	struct FormatPiece
+	{
+		size_t offset = 0;
+		size_t length = 0;
+		bool argument = false;
+	};
+
+	// summary of a format string, used to size the parsed table at compile time
+	struct FormatInfo
+	{
+		size_t pieces = 0;
+		size_t arguments = 0;
+		bool valid = true;
+	};
+
+	// format string parsed into pieces; "{{" and "}}" become one-char literals
+	template<size_t Count>
+	struct FormatSpec
+	{
+		FormatPiece pieces[Count == 0 ? 1 : Count]{};
+		size_t count = 0;
+	};
+
+	constexpr FormatInfo ScanFormat(std::string_view format)
+	{
+		FormatInfo info;
+		size_t i = 0;
+		while (i < format.size())
+		{
+			const char ch = format[i];
+			if (ch == '{' && i + 1 < format.size() && format[i + 1] == '}')
+			{
+				++info.pieces;
+				++info.arguments;
+				i += 2;
+			}
+			else if ((ch == '{' || ch == '}') && i + 1 < format.size() && format[i + 1] == ch)
+			{
+				++info.pieces;
+				i += 2;
+			}
+			else if (ch == '{' || ch == '}')
+			{
+				info.valid = false;
+				return info;
+			}
+			else
+			{
+				++info.pieces;
+				while (i < format.size() && format[i] != '{' && format[i] != '}')
+					++i;
+			}
+		}
+		return info;
+	}
+
+	template<size_t Count>
+	constexpr FormatSpec<Count> ParseFormat(std::string_view format)
+	{
+		FormatSpec<Count> spec;
+		size_t i = 0;
+		while (i < format.size() && spec.count < Count)
+		{
+			FormatPiece& piece = spec.pieces[spec.count++];
+			const char ch = format[i];
+			if (ch == '{' && i + 1 < format.size() && format[i + 1] == '}')
+			{
+				piece.offset = i;
+				piece.argument = true;
+				i += 2;
+			}
+			else if (ch == '{' || ch == '}')
+			{
+				piece.offset = i;
+				piece.length = 1;
+				i += 2;
+			}
+			else
+			{
+				piece.offset = i;
+				while (i < format.size() && format[i] != '{' && format[i] != '}')
+					++i;
+				piece.length = i - piece.offset;
+			}
+		}
+		return spec;
+	}
+
+	template<typename... Args>
+	constexpr std::integral_constant<size_t, sizeof...(Args)> CountFormatArguments(const Args&...) noexcept
+	{
+		return {};
+	}
+
+	// append-only char buffer that starts on the stack and moves to the heap only when it outgrows Capacity
+	template<size_t Capacity = 256>
+	class BasicFormatBuffer
+	{
+	private:
+		char local[Capacity];
+		std::unique_ptr<char[]> heap;
+		char* data = local;
+		size_t size = 0;
+		size_t capacity = Capacity;
+
+		void Grow(size_t required)
+		{
+			size_t next = capacity * 2;
+			while (next < required)
+				next *= 2;
+			std::unique_ptr<char[]> buffer(new char[next]);
+			std::memcpy(buffer.get(), data, size);
+			heap = std::move(buffer);
+			data = heap.get();
+			capacity = next;
+		}
+
+	public:
+		BasicFormatBuffer() = default;
+		BasicFormatBuffer(const BasicFormatBuffer&) = delete;
+		BasicFormatBuffer& operator=(const BasicFormatBuffer&) = delete;
+
+		void Append(const char* text, size_t length)
+		{
+			if (size + length > capacity)
+				Grow(size + length);
+			std::memcpy(data + size, text, length);
+			size += length;
+		}
+		void Append(std::string_view text)
+		{
+			Append(text.data(), text.size());
+		}
+		void Push(char ch)
+		{
+			if (size == capacity)
+				Grow(size + 1);
+			data[size++] = ch;
+		}
+		void Clear() noexcept
+		{
+			size = 0;
+		}
+
+		const char* GetData() const noexcept
+		{
+			return data;
+		}
+		size_t GetSize() const noexcept
+		{
+			return size;
+		}
+		std::string_view GetView() const noexcept
+		{
+			return std::string_view(data, size);
+		}
+		std::string ToString() const
+		{
+			return std::string(data, size);
+		}
+	};
+	using FormatBuffer = BasicFormatBuffer<>;
+
+	template<size_t Capacity>
+	void FormatWrite(BasicFormatBuffer<Capacity>& out, const char* text, size_t length)
+	{
+		out.Append(text, length);
+	}
+	inline void FormatWrite(std::string& out, const char* text, size_t length)
+	{
+		out.append(text, length);
+	}
+
+	// shortest text that reads back to the same value
+	template<typename Out, typename T>
+	void FormatFloat(Out& out, T value)
+	{
+		char buffer[64];
+#if defined(__cpp_lib_to_chars)
+		const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+		if (result.ec == std::errc())
+		{
+			FormatWrite(out, buffer, static_cast<size_t>(result.ptr - buffer));
+			return;
+		}
+#endif
+		// no floating to_chars: try increasing precision until the text round-trips
+		constexpr int max_digits = std::numeric_limits<T>::max_digits10;
+		int length = 0;
+		for (int digits = 1; digits <= max_digits; ++digits)
+		{
+			length = std::is_same_v<T, long double>
+				? snprintf(buffer, sizeof(buffer), "%.*Lg", digits, static_cast<long double>(value))
+				: snprintf(buffer, sizeof(buffer), "%.*g", digits, static_cast<double>(value));
+			if (length < 0 || static_cast<size_t>(length) >= sizeof(buffer))
+				throw std::runtime_error("Format failed: floating value does not fit");
+			if (std::is_same_v<T, float> ? std::strtof(buffer, nullptr) == value
+				: std::is_same_v<T, double> ? std::strtod(buffer, nullptr) == value
+				: std::strtold(buffer, nullptr) == value)
+				break;
+		}
+		FormatWrite(out, buffer, static_cast<size_t>(length));
+	}
+
+	// write one argument: strings as-is, bool as true/false, char as a character, numbers via to_chars
+	template<typename Out, typename T>
+	void FormatArgument(Out& out, const T& value)
+	{
+		if constexpr (std::is_convertible_v<const T&, std::string_view>)
+		{
+			const std::string_view text(value);
+			FormatWrite(out, text.data(), text.size());
+		}
+		else if constexpr (std::is_same_v<T, bool>)
+		{
+			if (value)
+				FormatWrite(out, "true", 4);
+			else
+				FormatWrite(out, "false", 5);
+		}
+		else if constexpr (std::is_same_v<T, char>)
+		{
+			FormatWrite(out, &value, 1);
+		}
+		else if constexpr (std::is_integral_v<T>)
+		{
+			char buffer[40];
+			const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+			FormatWrite(out, buffer, static_cast<size_t>(result.ptr - buffer));
+		}
+		else if constexpr (std::is_floating_point_v<T>)
+		{
+			FormatFloat(out, value);
+		}
+		else if constexpr (std::is_pointer_v<T>)
+		{
+			char buffer[2 + sizeof(uintptr_t) * 2] = { '0', 'x' };
+			const auto result = std::to_chars(buffer + 2, buffer + sizeof(buffer), reinterpret_cast<uintptr_t>(value), 16);
+			FormatWrite(out, buffer, static_cast<size_t>(result.ptr - buffer));
+		}
+		else if constexpr (HasToStringMember<T>::value)
+		{
+			const auto text = value.ToString();
+			FormatArgument(out, text);
+		}
+		else
+		{
+			static_assert(HasToStringMember<T>::value, "Format: argument type has no text form");
+		}
+	}
+
+	template<typename Out, size_t Count>
+	size_t FormatLiterals(Out& out, const FormatSpec<Count>& spec, std::string_view format, size_t index)
+	{
+		for (; index < spec.count && !spec.pieces[index].argument; ++index)
+			FormatWrite(out, format.data() + spec.pieces[index].offset, spec.pieces[index].length);
+		return index;
+	}
+
+	template<typename Out, size_t Count>
+	void FormatPieces(Out& out, const FormatSpec<Count>& spec, std::string_view format, size_t index)
+	{
+		FormatLiterals(out, spec, format, index);
+	}
+	template<typename Out, size_t Count, typename First, typename... Rest>
+	void FormatPieces(Out& out, const FormatSpec<Count>& spec, std::string_view format, size_t index, const First& first, const Rest&... rest)
+	{
+		index = FormatLiterals(out, spec, format, index);
+		FormatArgument(out, first);
+		FormatPieces(out, spec, format, index + 1, rest...);
+	}
+
+	// append the formatted text to out (a std::string or a BasicFormatBuffer)
+	template<typename Out, size_t Count, typename... Args>
+	void FormatTo(Out& out, const FormatSpec<Count>& spec, std::string_view format, const Args&... args)
+	{
+		FormatPieces(out, spec, format, 0, args...);
+	}
+
+	// format through a stack buffer so the only allocation is the returned string
+	template<size_t Count, typename... Args>
+	std::string Format(const FormatSpec<Count>& spec, std::string_view format, const Args&... args)
+	{
+		FormatBuffer buffer;
+		FormatPieces(buffer, spec, format, 0, args...);
+		return buffer.ToString();
+	}
+}
+
+// the format string is always the first variadic argument, so no macro needs an empty __VA_ARGS__
+// (portable without the GNU ", ##__VA_ARGS__" extension or C++20 __VA_OPT__)
+#define __CONVENTION_FORMAT_EXPAND(x) x
+#define __CONVENTION_FORMAT_FIRST_(first, ...) first
+#define __CONVENTION_FORMAT_FIRST(...) __CONVENTION_FORMAT_EXPAND(__CONVENTION_FORMAT_FIRST_(__VA_ARGS__, ~))
+// parse a "{}" format string at compile time and check it against the argument count
+#define __CONVENTION_FORMAT_SPEC(...) \
+	constexpr std::string_view __format_text = __CONVENTION_FORMAT_FIRST(__VA_ARGS__); \
+	constexpr ::Convention::FormatInfo __format_info = ::Convention::ScanFormat(__format_text); \
+	static_assert(__format_info.valid, "Format: unmatched '{' or '}' in format string"); \
+	static_assert(__format_info.arguments + 1 == decltype(::Convention::CountFormatArguments(__VA_ARGS__))::value, \
+		"Format: placeholder count does not match argument count"); \
+	constexpr auto __format_spec = ::Convention::ParseFormat<__format_info.pieces>(__format_text)
+// make_format("x = {}, y = {}", x, y) -> std::string
+#define make_format(...) \
+	([&]() { \
+		__CONVENTION_FORMAT_SPEC(__VA_ARGS__); \
+		return ::Convention::Format(__format_spec, __VA_ARGS__); \
+	}())
+// make_format_to(out, "x = {}", x) appends to a std::string or BasicFormatBuffer
+#define make_format_to(out, ...) \
+	([&]() { \
+		__CONVENTION_FORMAT_SPEC(__VA_ARGS__); \
+		::Convention::FormatTo(out, __format_spec, __VA_ARGS__); \
+	}())
+
+#pragma endregion
+
 #pragma region Kit
 
 #ifndef __init
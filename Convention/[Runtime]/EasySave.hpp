@@ -164,8 +164,7 @@ namespace Convention
 
             static void SaveRaw(const std::vector<uint8_t>& bytes, const EasySaveSettings& settings)
             {
-                // TODO: Implement raw byte saving with compression/encryption
-                ToolFile(settings.filePath).SaveAsBinary(bytes);
+                SaveRaw(ByteChain().Append(bytes), settings);
             }
 
             static void SaveRaw(const std::string& str)
@@ -181,8 +180,24 @@ namespace Convention
 
             static void SaveRaw(const std::string& str, const EasySaveSettings& settings)
             {
-                std::vector<uint8_t> bytes(str.begin(), str.end());
-                SaveRaw(bytes, settings);
+                SaveRaw(ByteChain().Append(str), settings);
+            }
+
+            static void SaveRaw(const ByteChain& chain)
+            {
+                SaveRaw(chain, EasySaveSettings());
+            }
+
+            static void SaveRaw(const ByteChain& chain, const std::string& filePath)
+            {
+                EasySaveSettings settings(filePath);
+                SaveRaw(chain, settings);
+            }
+
+            static void SaveRaw(const ByteChain& chain, const EasySaveSettings& settings)
+            {
+                // TODO: Implement raw byte saving with compression/encryption
+                ToolFile(settings.filePath).SaveAsBinary(chain);
             }
 
             // Load raw data
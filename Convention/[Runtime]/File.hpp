@@ -4,8 +4,198 @@
 
 #include "Config.hpp"
 
+#if defined(_WIN64)||defined(_WIN32)
+// 只需要文件映射相关的API，避免windows.h的min/max等宏与不常用的子头文件泄漏给包含方
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#define CONVENTION_FILE_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#ifdef CONVENTION_FILE_LEAN_AND_MEAN
+#undef WIN32_LEAN_AND_MEAN
+#undef CONVENTION_FILE_LEAN_AND_MEAN
+#endif
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace Convention
 {
+    /**
+     * @brief 不拥有内存的分散字节序列
+     * 按顺序记录若干段(指针, 长度)，写入时逐段写出而不拼接成连续内存；
+     * 使用期间各段引用的内存必须保持有效
+     */
+    class ByteChain
+    {
+    private:
+        std::vector<std::pair<const uint8_t*, size_t>> segments;
+        size_t size = 0;
+
+    public:
+        ByteChain() = default;
+
+        ByteChain& Append(const void* data, size_t length)
+        {
+            if (length == 0) return *this;
+            segments.emplace_back(static_cast<const uint8_t*>(data), length);
+            size += length;
+            return *this;
+        }
+
+        ByteChain& Append(const std::vector<uint8_t>& bytes)
+        {
+            return Append(bytes.data(), bytes.size());
+        }
+
+        ByteChain& Append(std::string_view text)
+        {
+            return Append(text.data(), text.length());
+        }
+
+        // 总字节数
+        size_t GetSize() const noexcept
+        {
+            return size;
+        }
+
+        const std::vector<std::pair<const uint8_t*, size_t>>& GetSegments() const noexcept
+        {
+            return segments;
+        }
+
+        // 需要连续内存时才复制为一个字节数组
+        std::vector<uint8_t> Flatten() const
+        {
+            std::vector<uint8_t> result;
+            result.reserve(size);
+            for (const auto& [data, length] : segments)
+                result.insert(result.end(), data, data + length);
+            return result;
+        }
+    };
+
+    /**
+     * @brief 只读内存映射的文件视图
+     * 映射期间文件内容由操作系统按需分页读入，不占用额外的堆内存；
+     * 对象只能移动，析构时解除映射。空文件得到长度为0的视图
+     */
+    class ToolFileMapping
+    {
+    private:
+        const char* data = nullptr;
+        size_t size = 0;
+#if defined(_WIN64)||defined(_WIN32)
+        HANDLE fileHandle = INVALID_HANDLE_VALUE;
+        HANDLE mappingHandle = nullptr;
+#endif
+
+        void Release() noexcept
+        {
+#if defined(_WIN64)||defined(_WIN32)
+            if (data != nullptr) UnmapViewOfFile(data);
+            if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+            if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+            fileHandle = INVALID_HANDLE_VALUE;
+            mappingHandle = nullptr;
+#else
+            if (data != nullptr) munmap(const_cast<char*>(data), size);
+#endif
+            data = nullptr;
+            size = 0;
+        }
+
+    public:
+        ToolFileMapping() = default;
+        explicit ToolFileMapping(const std::filesystem::path& path)
+        {
+#if defined(_WIN64)||defined(_WIN32)
+            fileHandle = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (fileHandle == INVALID_HANDLE_VALUE) throw std::runtime_error("Cannot open file");
+            LARGE_INTEGER fileSize{};
+            if (!GetFileSizeEx(fileHandle, &fileSize))
+            {
+                Release();
+                throw std::runtime_error("Cannot get file size");
+            }
+            if (fileSize.QuadPart == 0) return;
+            mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mappingHandle == nullptr)
+            {
+                Release();
+                throw std::runtime_error("Cannot map file");
+            }
+            data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+            if (data == nullptr)
+            {
+                Release();
+                throw std::runtime_error("Cannot map file");
+            }
+            size = static_cast<size_t>(fileSize.QuadPart);
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) throw std::runtime_error("Cannot open file");
+            struct stat info {};
+            if (fstat(fd, &info) != 0)
+            {
+                ::close(fd);
+                throw std::runtime_error("Cannot get file size");
+            }
+            if (info.st_size > 0)
+            {
+                void* address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (address == MAP_FAILED)
+                {
+                    ::close(fd);
+                    throw std::runtime_error("Cannot map file");
+                }
+                madvise(address, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+                data = static_cast<const char*>(address);
+                size = static_cast<size_t>(info.st_size);
+            }
+            ::close(fd);
+#endif
+        }
+        ToolFileMapping(const ToolFileMapping&) = delete;
+        ToolFileMapping& operator=(const ToolFileMapping&) = delete;
+        ToolFileMapping(ToolFileMapping&& other) noexcept
+        {
+            *this = std::move(other);
+        }
+        ToolFileMapping& operator=(ToolFileMapping&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Release();
+                std::swap(data, other.data);
+                std::swap(size, other.size);
+#if defined(_WIN64)||defined(_WIN32)
+                std::swap(fileHandle, other.fileHandle);
+                std::swap(mappingHandle, other.mappingHandle);
+#endif
+            }
+            return *this;
+        }
+        ~ToolFileMapping()
+        {
+            Release();
+        }
+
+        const char* GetData() const noexcept { return data; }
+        size_t GetSize() const noexcept { return size; }
+        std::string_view GetView() const noexcept
+        {
+            return size == 0 ? std::string_view() : std::string_view(data, size);
+        }
+    };
+
     class ToolFile
     {
     private:
@@ -142,6 +332,13 @@ namespace Convention
             return result;
         }
 
+        // 只读内存映射，适合顺序扫描大文件
+        ToolFileMapping MapAsReadOnly() const
+        {
+            if (!IsFile()) throw std::runtime_error("Target is not a file");
+            return ToolFileMapping(FullPath);
+        }
+
         void SaveAsText(const std::string& data)
         {
             MustExistsPath();
@@ -158,6 +355,17 @@ namespace Convention
             file.write(reinterpret_cast<const char*>(data.data()), data.size());
         }
 
+        // 逐段写出分散的字节序列，不拼接
+        void SaveAsBinary(const ByteChain& data)
+        {
+            MustExistsPath();
+            std::ofstream file(FullPath, std::ios::binary);
+            if (!file.is_open()) throw std::runtime_error("Cannot create file");
+            for (const auto& [bytes, length] : data.GetSegments())
+                file.write(reinterpret_cast<const char*>(bytes), static_cast<std::streamsize>(length));
+            if (!file) throw std::runtime_error("Cannot write file");
+        }
+
         static void SaveDataAsBinary(const std::string& path, const std::vector<uint8_t>& data)
         {
             ToolFile(path).SaveAsBinary(data);
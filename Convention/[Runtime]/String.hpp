@@ -3,9 +3,292 @@
 #define Convention_Runtime_String_Hpp
 
 #include "Config.hpp"
+#include "File.hpp"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CONVENTION_STRING_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+#endif
+
+// GCC/Clang需要为使用扩展指令集的函数单独指定目标，MSVC可直接使用内建函数
+#if defined(CONVENTION_STRING_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CONVENTION_TARGET_AVX2 __attribute__((target("avx2")))
+#define CONVENTION_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define CONVENTION_TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#define CONVENTION_TARGET_AVX2
+#define CONVENTION_TARGET_SSE41
+#define CONVENTION_TARGET_SSE2
+#endif
 
 namespace Convention
 {
+	/**
+	 * @brief 运行时CPU指令集检测（结果在首次调用后缓存）
+	 */
+	struct SIMDIndicator
+	{
+		static bool HasSSE2() noexcept
+		{
+			static const bool value = Detect(Feature::SSE2);
+			return value;
+		}
+		static bool HasSSE41() noexcept
+		{
+			static const bool value = Detect(Feature::SSE41);
+			return value;
+		}
+		static bool HasAVX2() noexcept
+		{
+			static const bool value = Detect(Feature::AVX2);
+			return value;
+		}
+
+	private:
+		enum class Feature
+		{
+			SSE2,
+			SSE41,
+			AVX2
+		};
+
+		static bool Detect(Feature feature) noexcept
+		{
+#if defined(CONVENTION_STRING_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+			__builtin_cpu_init();
+			switch (feature)
+			{
+			case Feature::SSE2:
+				return __builtin_cpu_supports("sse2");
+			case Feature::SSE41:
+				return __builtin_cpu_supports("sse4.1");
+			default:
+				return __builtin_cpu_supports("avx2");
+			}
+#elif defined(CONVENTION_STRING_SIMD_X86) && defined(_MSC_VER)
+			int info[4] = { 0 };
+			__cpuid(info, 0);
+			const int max_leaf = info[0];
+			if (max_leaf < 1)
+				return false;
+			__cpuid(info, 1);
+			if (feature == Feature::SSE2)
+				return (info[3] & (1 << 26)) != 0;
+			const bool sse41 = (info[2] & (1 << 19)) != 0;
+			if (feature == Feature::SSE41)
+				return sse41;
+			// AVX2还需要操作系统保存YMM寄存器
+			const bool osxsave = (info[2] & (1 << 27)) != 0;
+			if (!osxsave || max_leaf < 7)
+				return false;
+			if ((_xgetbv(0) & 0x6) != 0x6)
+				return false;
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#else
+			(void)feature;
+			return false;
+#endif
+		}
+	};
+
+	/**
+	 * @brief 最低位1的下标（value不能为0）
+	 */
+	inline int _count_trailing_zeros32(uint32_t value) noexcept
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_ctz(value);
+#elif defined(_MSC_VER)
+		unsigned long index = 0;
+		_BitScanForward(&index, value);
+		return static_cast<int>(index);
+#else
+		int count = 0;
+		while ((value & 1) == 0)
+		{
+			value >>= 1;
+			++count;
+		}
+		return count;
+#endif
+	}
+
+	/**
+	 * @brief 最高位1之上的0的个数（value不能为0）
+	 */
+	inline int _count_leading_zeros32(uint32_t value) noexcept
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_clz(value);
+#elif defined(_MSC_VER)
+		unsigned long index = 0;
+		_BitScanReverse(&index, value);
+		return 31 - static_cast<int>(index);
+#else
+		int count = 0;
+		while ((value & 0x80000000u) == 0)
+		{
+			value <<= 1;
+			++count;
+		}
+		return count;
+#endif
+	}
+
+#ifdef CONVENTION_STRING_SIMD_X86
+	/**
+	 * @brief AVX2: 每步比较64字节，返回第一个不同字节的下标或停止扫描的位置
+	 */
+	CONVENTION_TARGET_AVX2 inline size_t _mismatch_forward_avx2(const char* a, const char* b, size_t n) noexcept
+	{
+		size_t i = 0;
+		for (; i + 64 <= n; i += 64)
+		{
+			const uint32_t low = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)))));
+			const uint32_t high = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 32)),
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 32)))));
+			if ((low & high) != 0xFFFFFFFFu)
+				return low != 0xFFFFFFFFu ? i + _count_trailing_zeros32(~low) : i + 32 + _count_trailing_zeros32(~high);
+		}
+		for (; i + 32 <= n; i += 32)
+		{
+			const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)))));
+			if (mask != 0xFFFFFFFFu)
+				return i + _count_trailing_zeros32(~mask);
+		}
+		return i;
+	}
+
+	/**
+	 * @brief AVX2: 从a_end/b_end向前每步比较64字节，返回末尾相同的字节数（可能因剩余不足一步而偏小）
+	 */
+	CONVENTION_TARGET_AVX2 inline size_t _mismatch_backward_avx2(const char* a_end, const char* b_end, size_t n) noexcept
+	{
+		size_t i = 0;
+		for (; i + 64 <= n; i += 64)
+		{
+			const uint32_t high = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_end - i - 32)),
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b_end - i - 32)))));
+			const uint32_t low = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_end - i - 64)),
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b_end - i - 64)))));
+			if ((low & high) != 0xFFFFFFFFu)
+				return high != 0xFFFFFFFFu ? i + _count_leading_zeros32(~high) : i + 32 + _count_leading_zeros32(~low);
+		}
+		for (; i + 32 <= n; i += 32)
+		{
+			const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_end - i - 32)),
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b_end - i - 32)))));
+			if (mask != 0xFFFFFFFFu)
+				return i + _count_leading_zeros32(~mask);
+		}
+		return i;
+	}
+
+	/**
+	 * @brief SSE2: 每步比较32字节，返回第一个不同字节的下标或停止扫描的位置
+	 */
+	CONVENTION_TARGET_SSE2 inline size_t _mismatch_forward_sse2(const char* a, const char* b, size_t n) noexcept
+	{
+		size_t i = 0;
+		for (; i + 32 <= n; i += 32)
+		{
+			const uint32_t low = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)))));
+			const uint32_t high = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 16)),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 16)))));
+			const uint32_t mask = low | (high << 16);
+			if (mask != 0xFFFFFFFFu)
+				return i + _count_trailing_zeros32(~mask);
+		}
+		return i;
+	}
+
+	/**
+	 * @brief SSE2: 从a_end/b_end向前每步比较32字节，返回末尾相同的字节数（可能偏小）
+	 */
+	CONVENTION_TARGET_SSE2 inline size_t _mismatch_backward_sse2(const char* a_end, const char* b_end, size_t n) noexcept
+	{
+		size_t i = 0;
+		for (; i + 32 <= n; i += 32)
+		{
+			const uint32_t low = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(a_end - i - 32)),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(b_end - i - 32)))));
+			const uint32_t high = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(a_end - i - 16)),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(b_end - i - 16)))));
+			const uint32_t mask = low | (high << 16);
+			if (mask != 0xFFFFFFFFu)
+				return i + _count_leading_zeros32(~mask);
+		}
+		return i;
+	}
+#endif // CONVENTION_STRING_SIMD_X86
+
+	/**
+	 * @brief 两个字符串公共前缀的字节数（可用时按AVX2/SSE2整块比较）
+	 */
+	inline size_t _common_prefix_length(std::string_view a, std::string_view b) noexcept
+	{
+		const size_t n = std::min(a.length(), b.length());
+		size_t i = 0;
+#ifdef CONVENTION_STRING_SIMD_X86
+		if (SIMDIndicator::HasAVX2())
+			i = _mismatch_forward_avx2(a.data(), b.data(), n);
+		else if (SIMDIndicator::HasSSE2())
+			i = _mismatch_forward_sse2(a.data(), b.data(), n);
+#endif
+		while (i < n && a[i] == b[i])
+			++i;
+		return i;
+	}
+
+	/**
+	 * @brief 两个字符串公共后缀的字节数（可用时按AVX2/SSE2整块比较）
+	 */
+	inline size_t _common_suffix_length(std::string_view a, std::string_view b) noexcept
+	{
+		const size_t n = std::min(a.length(), b.length());
+		const char* a_end = a.data() + a.length();
+		const char* b_end = b.data() + b.length();
+		size_t i = 0;
+#ifdef CONVENTION_STRING_SIMD_X86
+		if (SIMDIndicator::HasAVX2())
+			i = _mismatch_backward_avx2(a_end, b_end, n);
+		else if (SIMDIndicator::HasSSE2())
+			i = _mismatch_backward_sse2(a_end, b_end, n);
+#endif
+		while (i < n && a_end[-1 - static_cast<ptrdiff_t>(i)] == b_end[-1 - static_cast<ptrdiff_t>(i)])
+			++i;
+		return i;
+	}
+
 	/**
 	 * @brief 限制字符串长度，如果超过最大长度则截取头尾部分并在中间添加省略号
 	 * @tparam StringType 字符串类型 (std::string, std::wstring等)
@@ -112,6 +395,386 @@ namespace Convention
 		}
 	}
 
+	/**
+	 * @brief 单元格文本的暂存区，数值在此格式化，字符串类数据直接引用不复制
+	 */
+	struct _CellBuffer
+	{
+		char data[512];
+		std::string overflow;  // 超出data容量时使用（如极大的long double）
+	};
+
+	/**
+	 * @brief 取得data的文本形式，与FillString/LimitStringLength的std::string转换结果一致
+	 * 整数与浮点数经std::to_chars写入缓冲区（浮点为与std::to_string相同的定点6位小数）
+	 * @return 指向data本身或buffer的视图，在buffer与data存活期间有效
+	 */
+	template<typename DataType>
+	std::string_view _cell_text(const DataType& data, _CellBuffer& buffer)
+	{
+		if constexpr (std::is_convertible_v<const DataType&, std::string_view>)
+		{
+			return std::string_view(data);
+		}
+		else if constexpr (std::is_same_v<DataType, bool>)
+		{
+			return data ? "1" : "0";
+		}
+		else if constexpr (std::is_integral_v<DataType>)
+		{
+			const auto result = std::to_chars(buffer.data, buffer.data + sizeof(buffer.data), data);
+			return std::string_view(buffer.data, static_cast<size_t>(result.ptr - buffer.data));
+		}
+		else if constexpr (std::is_floating_point_v<DataType>)
+		{
+#if defined(__cpp_lib_to_chars)
+			const auto result = std::to_chars(buffer.data, buffer.data + sizeof(buffer.data), data, std::chars_format::fixed, 6);
+			if (result.ec == std::errc())
+				return std::string_view(buffer.data, static_cast<size_t>(result.ptr - buffer.data));
+#else
+			const int count = std::is_same_v<DataType, long double>
+				? std::snprintf(buffer.data, sizeof(buffer.data), "%Lf", static_cast<long double>(data))
+				: std::snprintf(buffer.data, sizeof(buffer.data), "%f", static_cast<double>(data));
+			if (count >= 0 && static_cast<size_t>(count) < sizeof(buffer.data))
+				return std::string_view(buffer.data, static_cast<size_t>(count));
+#endif
+			buffer.overflow = std::to_string(data);
+			return buffer.overflow;
+		}
+		else
+		{
+			buffer.overflow = std::string(data);
+			return buffer.overflow;
+		}
+	}
+
+	/**
+	 * @brief 填充对齐方式
+	 */
+	enum class FillSide
+	{
+		Left,    // 左对齐，在右侧填充
+		Right,   // 右对齐，在左侧填充
+		Center   // 居中
+	};
+
+	/**
+	 * @brief 解析FillString使用的对齐方式字符串
+	 */
+	inline FillSide _parse_fill_side(const char* side)
+	{
+		if (strcmp(side, "left") == 0)
+			return FillSide::Left;
+		if (strcmp(side, "right") == 0)
+			return FillSide::Right;
+		if (strcmp(side, "center") == 0)
+			return FillSide::Center;
+		throw std::invalid_argument("Unsupported side: must be 'left', 'right', or 'center'");
+	}
+
+	/**
+	 * @brief 将text按对齐方式填充到max_length写入输出迭代器
+	 * @return 写入结束后的迭代器
+	 */
+	template<typename OutputIt>
+	OutputIt _write_filled(OutputIt out, std::string_view text, size_t max_length, char fill_char, FillSide side)
+	{
+		const size_t fill_count = text.length() < max_length ? max_length - text.length() : 0;
+		const size_t left = side == FillSide::Right ? fill_count
+			: side == FillSide::Center ? fill_count / 2 : 0;
+		out = std::fill_n(out, left, fill_char);
+		out = std::copy(text.begin(), text.end(), out);
+		return std::fill_n(out, fill_count - left, fill_char);
+	}
+
+	/**
+	 * @brief FillString写入后的长度，可用于预先分配缓冲区
+	 */
+	template<typename DataType>
+	size_t GetFillStringLength(const DataType& data, size_t max_length = 50)
+	{
+		_CellBuffer buffer;
+		return std::max(_cell_text(data, buffer).length(), max_length);
+	}
+
+	/**
+	 * @brief FillString的输出迭代器版本，不产生中间字符串
+	 * @param out 输出迭代器，需可写入GetFillStringLength(data, max_length)个字符
+	 * @return 写入结束后的迭代器
+	 */
+	template<typename OutputIt, typename DataType>
+	OutputIt FillStringTo(
+		OutputIt out,
+		const DataType& data,
+		size_t max_length = 50,
+		char fill_char = ' ',
+		const char* side = "right")
+	{
+		const FillSide fill_side = _parse_fill_side(side);
+		_CellBuffer buffer;
+		return _write_filled(out, _cell_text(data, buffer), max_length, fill_char, fill_side);
+	}
+
+	/**
+	 * @brief FillString的追加版本，按精确长度扩展output后原地写入
+	 */
+	template<typename DataType>
+	void AppendFillString(
+		std::string& output,
+		const DataType& data,
+		size_t max_length = 50,
+		char fill_char = ' ',
+		const char* side = "right")
+	{
+		const FillSide fill_side = _parse_fill_side(side);
+		_CellBuffer buffer;
+		const std::string_view text = _cell_text(data, buffer);
+		const size_t offset = output.size();
+		output.resize(offset + std::max(text.length(), max_length));
+		_write_filled(output.data() + offset, text, max_length, fill_char, fill_side);
+	}
+
+	/**
+	 * @brief 计算LimitStringLength截取的头尾长度
+	 * @return {头部长度, 尾部长度}；不需要截取时头部为全文、尾部为0
+	 */
+	inline std::pair<size_t, size_t> _limit_split(size_t length, size_t max_length, size_t inside_length)
+	{
+		if (length <= max_length)
+			return { length, 0 };
+		const size_t head_length = std::min(max_length / 2, length);
+		const size_t rest = max_length - max_length / 2;
+		const size_t tail_length = std::min(rest > inside_length ? rest - inside_length : 0, length - head_length);
+		return { head_length, tail_length };
+	}
+
+	/**
+	 * @brief LimitStringLength写入后的长度，可用于预先分配缓冲区
+	 */
+	template<typename DataType>
+	size_t GetLimitStringLength(const DataType& data, size_t max_length = 50)
+	{
+		_CellBuffer buffer;
+		const size_t length = _cell_text(data, buffer).length();
+		if (length <= max_length)
+			return length;
+		const auto [head, tail] = _limit_split(length, max_length, 9);
+		return head + 9 + tail;
+	}
+
+	/**
+	 * @brief LimitStringLength的输出迭代器版本，不产生中间字符串
+	 * @param out 输出迭代器，需可写入GetLimitStringLength(data, max_length)个字符
+	 * @return 写入结束后的迭代器
+	 */
+	template<typename OutputIt, typename DataType>
+	OutputIt LimitStringLengthTo(OutputIt out, const DataType& data, size_t max_length = 50)
+	{
+		constexpr std::string_view inside_str = "\n...\n...\n";
+		_CellBuffer buffer;
+		const std::string_view text = _cell_text(data, buffer);
+		if (text.length() <= max_length)
+			return std::copy(text.begin(), text.end(), out);
+		const auto [head, tail] = _limit_split(text.length(), max_length, inside_str.length());
+		out = std::copy(text.begin(), text.begin() + head, out);
+		out = std::copy(inside_str.begin(), inside_str.end(), out);
+		return std::copy(text.end() - tail, text.end(), out);
+	}
+
+	/**
+	 * @brief LimitStringLength的追加版本，按精确长度扩展output后原地写入
+	 */
+	template<typename DataType>
+	void AppendLimitStringLength(std::string& output, const DataType& data, size_t max_length = 50)
+	{
+		constexpr std::string_view inside_str = "\n...\n...\n";
+		_CellBuffer buffer;
+		const std::string_view text = _cell_text(data, buffer);
+		if (text.length() <= max_length)
+		{
+			output.append(text);
+			return;
+		}
+		const auto [head, tail] = _limit_split(text.length(), max_length, inside_str.length());
+		output.reserve(output.size() + head + inside_str.length() + tail);
+		output.append(text.substr(0, head));
+		output.append(inside_str);
+		output.append(text.substr(text.length() - tail));
+	}
+
+	/**
+	 * @brief 按列对齐格式化整张表
+	 * 先求出各列最大宽度与总长度，一次分配后逐格填充写入；每行以'\n'结尾
+	 * @param rows 行列表，各行的单元格数可以不同，单元格可为字符串或数值
+	 * @param separator 相邻列之间的分隔符
+	 * @param fill_char 填充字符（默认空格）
+	 * @param side 对齐方式，同FillString（默认right）
+	 * @return 格式化后的表格文本
+	 */
+	template<typename CellType>
+	std::string FormatTable(
+		const std::vector<std::vector<CellType>>& rows,
+		std::string_view separator = " ",
+		char fill_char = ' ',
+		const char* side = "right")
+	{
+		const FillSide fill_side = _parse_fill_side(side);
+		_CellBuffer buffer;
+
+		std::vector<size_t> widths;
+		for (const auto& row : rows)
+		{
+			if (row.size() > widths.size())
+				widths.resize(row.size(), 0);
+			for (size_t c = 0; c < row.size(); ++c)
+				widths[c] = std::max(widths[c], _cell_text(row[c], buffer).length());
+		}
+
+		size_t total = 0;
+		for (const auto& row : rows)
+		{
+			for (size_t c = 0; c < row.size(); ++c)
+				total += widths[c];
+			total += (row.empty() ? 0 : (row.size() - 1) * separator.length()) + 1;
+		}
+
+		std::string result(total, '\0');
+		char* out = result.data();
+		for (const auto& row : rows)
+		{
+			for (size_t c = 0; c < row.size(); ++c)
+			{
+				if (c != 0)
+					out = std::copy(separator.begin(), separator.end(), out);
+				out = _write_filled(out, _cell_text(row[c], buffer), widths[c], fill_char, fill_side);
+			}
+			*out++ = '\n';
+		}
+		return result;
+	}
+
+	/**
+	 * @brief ParseNumberColumn的结果
+	 */
+	struct ColumnParseResult
+	{
+		std::errc ec = std::errc();  // 成功时为std::errc()
+		size_t field = 0;            // 出错字段的序号
+		size_t offset = 0;           // 出错字段在文本中的起始偏移
+	};
+
+	/**
+	 * @brief 收集data中所有分隔符的位置（加上base后写入positions）
+	 * @return 已检查的字节数，剩余不足一整块的部分由调用方处理
+	 */
+#ifdef CONVENTION_STRING_SIMD_X86
+	CONVENTION_TARGET_AVX2 inline size_t _collect_delimiters_avx2(
+		const char* data, size_t n, size_t base, char delimiter, std::vector<size_t>& positions)
+	{
+		const __m256i needle = _mm256_set1_epi8(delimiter);
+		size_t i = 0;
+		for (; i + 32 <= n; i += 32)
+		{
+			uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), needle)));
+			for (; mask != 0; mask &= mask - 1)
+				positions.push_back(base + i + _count_trailing_zeros32(mask));
+		}
+		return i;
+	}
+
+	CONVENTION_TARGET_SSE2 inline size_t _collect_delimiters_sse2(
+		const char* data, size_t n, size_t base, char delimiter, std::vector<size_t>& positions)
+	{
+		const __m128i needle = _mm_set1_epi8(delimiter);
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16)
+		{
+			uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), needle)));
+			for (; mask != 0; mask &= mask - 1)
+				positions.push_back(base + i + _count_trailing_zeros32(mask));
+		}
+		return i;
+	}
+#endif // CONVENTION_STRING_SIMD_X86
+
+	inline void _collect_delimiters(const char* data, size_t n, size_t base, char delimiter, std::vector<size_t>& positions)
+	{
+		size_t i = 0;
+#ifdef CONVENTION_STRING_SIMD_X86
+		if (SIMDIndicator::HasAVX2())
+			i = _collect_delimiters_avx2(data, n, base, delimiter, positions);
+		else if (SIMDIndicator::HasSSE2())
+			i = _collect_delimiters_sse2(data, n, base, delimiter, positions);
+#endif
+		for (; i < n; ++i)
+			if (data[i] == delimiter)
+				positions.push_back(base + i);
+	}
+
+	/**
+	 * @brief 去掉字段首尾的空格、制表符与回车
+	 */
+	inline std::string_view _trim_field(std::string_view field) noexcept
+	{
+		size_t begin = 0, end = field.size();
+		while (begin < end && (field[begin] == ' ' || field[begin] == '\t' || field[begin] == '\r'))
+			++begin;
+		while (end > begin && (field[end - 1] == ' ' || field[end - 1] == '\t' || field[end - 1] == '\r'))
+			--end;
+		return field.substr(begin, end - begin);
+	}
+
+	/**
+	 * @brief 将按分隔符排列的一列数值批量解析到values末尾
+	 * 分隔符位置由AVX2/SSE2整块比较得到，每个字段经StringIndicator::TryToValue解析，不抛出异常；
+	 * 字段首尾的空格、制表符与回车会被忽略，文本末尾的空字段（如结尾换行）不计入
+	 * @tparam T bool、整数或浮点类型
+	 * @param text 输入文本
+	 * @param values 输出数组，出错时保留出错字段之前已解析的值
+	 * @param delimiter 字段分隔符（默认换行）
+	 * @return 解析结果，出错时指明出错的字段
+	 */
+	template<typename T>
+	ColumnParseResult ParseNumberColumn(std::string_view text, std::vector<T>& values, char delimiter = '\n')
+	{
+		constexpr size_t block_size = 1 << 16;  // 分块收集分隔符，位置表不随文本长度增长
+		ColumnParseResult result;
+		std::vector<size_t> positions;
+		size_t field_begin = 0;
+
+		const auto parse_field = [&](size_t begin, size_t end) -> bool
+		{
+			T value{};
+			const std::errc ec = StringIndicator::TryToValue(_trim_field(text.substr(begin, end - begin)), value);
+			if (ec != std::errc())
+			{
+				result.ec = ec;
+				result.offset = begin;
+				return false;
+			}
+			values.push_back(value);
+			++result.field;
+			return true;
+		};
+
+		for (size_t block = 0; block < text.size(); block += block_size)
+		{
+			positions.clear();
+			_collect_delimiters(text.data() + block, std::min(block_size, text.size() - block), block, delimiter, positions);
+			for (size_t position : positions)
+			{
+				if (!parse_field(field_begin, position))
+					return result;
+				field_begin = position + 1;
+			}
+		}
+		if (!_trim_field(text.substr(field_begin)).empty())
+			parse_field(field_begin, text.size());
+		return result;
+	}
+
 	/**
 	 * @brief 将字节数组转换为字符串数组
 	 * @param lines 字节数组列表
@@ -155,21 +818,18 @@ namespace Convention
 	 */
 	inline std::string Bytes2String(const std::vector<std::vector<uint8_t>>& lines)
 	{
-		auto strings = Bytes2Strings(lines);
-		std::string result;
-
-		// 预先计算总长度
+		// 预先计算总长度，再从各字节数组直接复制，不经过中间字符串
 		size_t total_length = 0;
-		for (const auto& str : strings)
+		for (const auto& line : lines)
 		{
-			total_length += str.length();
+			total_length += line.size();
 		}
-		result.reserve(total_length);
 
-		// 连接所有字符串
-		for (const auto& str : strings)
+		std::string result;
+		result.reserve(total_length);
+		for (const auto& line : lines)
 		{
-			result += str;
+			result.append(reinterpret_cast<const char*>(line.data()), line.size());
 		}
 
 		return result;
@@ -182,21 +842,18 @@ namespace Convention
 	 */
 	inline std::string Bytes2String(const std::vector<std::pair<const char*, size_t>>& lines)
 	{
-		auto strings = Bytes2Strings(lines);
-		std::string result;
-
-		// 预先计算总长度
+		// 预先计算总长度，再从各段直接复制，不经过中间字符串
 		size_t total_length = 0;
-		for (const auto& str : strings)
+		for (const auto& [ptr, len] : lines)
 		{
-			total_length += str.length();
+			total_length += len;
 		}
-		result.reserve(total_length);
 
-		// 连接所有字符串
-		for (const auto& str : strings)
+		std::string result;
+		result.reserve(total_length);
+		for (const auto& [ptr, len] : lines)
 		{
-			result += str;
+			result.append(ptr, len);
 		}
 
 		return result;
@@ -228,100 +885,691 @@ namespace Convention
 	};
 
 	/**
-	 * @brief 计算两个字符串的编辑距离和操作序列
-	 * 使用LCS算法来找到最长公共子序列，然后基于LCS生成操作序列
-	 * @param s1 源字符串
-	 * @param s2 目标字符串
-	 * @return (编辑距离, 操作序列)
+	 * @brief 引用源字符串的操作，不复制内容
+	 * 删除操作的content指向源字符串，添加操作的content指向目标字符串，
+	 * 使用期间两者必须保持有效
 	 */
-	inline std::pair<int, std::vector<StringOperation>> GetEditorDistanceAndOperations(
-		const std::string& s1,
-		const std::string& s2)
+	struct StringOperationRef
 	{
-		size_t m = s1.length();
-		size_t n = s2.length();
+		StringOpType type;          // 操作类型
+		size_t start;               // 开始位置
+		size_t end;                 // 结束位置
+		std::string_view content;   // 操作内容（引用）
 
-		// 使用LCS算法构建动态规划表
-		std::vector<std::vector<int>> lcs(m + 1, std::vector<int>(n + 1, 0));
+		StringOperationRef(StringOpType t, size_t s, size_t e, std::string_view c)
+			: type(t), start(s), end(e), content(c) {
+		}
 
-		// 构建LCS表
-		for (size_t i = 1; i <= m; ++i)
+		/**
+		 * @brief 复制内容，得到独立的操作
+		 */
+		StringOperation ToOperation() const
 		{
-			for (size_t j = 1; j <= n; ++j)
-			{
-				if (s1[i - 1] == s2[j - 1])
-				{
-					lcs[i][j] = lcs[i - 1][j - 1] + 1;
-				}
-				else
+			return StringOperation(type, start, end, std::string(content));
+		}
+	};
+
+	/**
+	 * @brief 将引用操作序列转换为独立的操作序列
+	 */
+	inline std::vector<StringOperation> MaterializeOperations(const std::vector<StringOperationRef>& operations)
+	{
+		std::vector<StringOperation> result;
+		result.reserve(operations.size());
+		for (const auto& op : operations)
+			result.push_back(op.ToOperation());
+		return result;
+	}
+
+	/**
+	 * @brief 按顺序应用操作序列，单次遍历并预先分配准确的结果长度
+	 * 操作位置基于base，必须按位置排列且删除范围互不重叠（GetDiffOperations的输出满足该要求）
+	 * @param base 源字符串
+	 * @param operations 操作序列（StringOperation或StringOperationRef）
+	 * @return 应用后的字符串
+	 */
+	template<typename Operation>
+	std::string _apply_operations(std::string_view base, const std::vector<Operation>& operations)
+	{
+		// 先校验并计算结果长度
+		size_t length = base.length();
+		size_t cursor = 0;
+		for (const auto& op : operations)
+		{
+			if (op.start < cursor || op.end < op.start || op.end > base.length())
+				throw std::invalid_argument("operations are out of order or out of range");
+			if (op.type == StringOpType::Delete)
+			{
+				length -= op.end - op.start;
+				cursor = op.end;
+			}
+			else
+			{
+				length += op.content.length();
+				cursor = op.start;
+			}
+		}
+
+		std::string result;
+		result.reserve(length);
+		cursor = 0;
+		for (const auto& op : operations)
+		{
+			result.append(base.data() + cursor, op.start - cursor);
+			if (op.type == StringOpType::Delete)
+			{
+				cursor = op.end;
+			}
+			else
+			{
+				result.append(op.content.data(), op.content.length());
+				cursor = op.start;
+			}
+		}
+		result.append(base.data() + cursor, base.length() - cursor);
+		return result;
+	}
+
+	inline std::string ApplyOperations(std::string_view base, const std::vector<StringOperation>& operations)
+	{
+		return _apply_operations(base, operations);
+	}
+
+	inline std::string ApplyOperations(std::string_view base, const std::vector<StringOperationRef>& operations)
+	{
+		return _apply_operations(base, operations);
+	}
+
+	/**
+	 * @brief 二进制差异格式的指令
+	 * 每条指令为一个varint: (参数 << 2) | 指令；Insert之后紧跟参数个字节的内容
+	 */
+	enum class _DeltaOp : uint8_t
+	{
+		Copy = 0,    // 从base当前位置复制n个字节
+		Insert = 1,  // 插入随后的n个字节
+		Skip = 2     // base当前位置移动zigzag编码的有符号偏移（删除时为正）
+	};
+
+	inline void _write_varint(std::vector<uint8_t>& output, uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			output.push_back(static_cast<uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+		output.push_back(static_cast<uint8_t>(value));
+	}
+
+	inline uint64_t _read_varint(const uint8_t*& data, const uint8_t* end)
+	{
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			if (data == end)
+				throw std::invalid_argument("truncated delta");
+			const uint8_t byte = *data++;
+			value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+				return value;
+		}
+		throw std::invalid_argument("malformed varint in delta");
+	}
+
+	inline uint64_t _zigzag_encode(int64_t value) noexcept
+	{
+		return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+	}
+
+	inline int64_t _zigzag_decode(uint64_t value) noexcept
+	{
+		return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+	}
+
+	inline void _write_delta_op(std::vector<uint8_t>& output, _DeltaOp op, uint64_t argument)
+	{
+		_write_varint(output, (argument << 2) | static_cast<uint64_t>(op));
+	}
+
+	/**
+	 * @brief 将操作序列编码为紧凑的二进制差异
+	 * 格式: varint(base长度) varint(结果长度) 指令...
+	 * 位置以相对base游标的复制/跳过长度表示，删除的内容不写入差异
+	 * @param operations 操作序列（位置基于base，按位置排列）
+	 * @param base_length base的长度
+	 * @return 编码后的字节
+	 */
+	inline std::vector<uint8_t> EncodeOperations(const std::vector<StringOperation>& operations, size_t base_length)
+	{
+		std::vector<uint8_t> body;
+		size_t result_length = base_length;
+		size_t cursor = 0;
+		for (const auto& op : operations)
+		{
+			if (op.start < cursor || op.end < op.start || op.end > base_length)
+				throw std::invalid_argument("operations are out of order or out of range");
+			if (op.start > cursor)
+				_write_delta_op(body, _DeltaOp::Copy, op.start - cursor);
+			if (op.type == StringOpType::Delete)
+			{
+				if (op.end > op.start)
+					_write_delta_op(body, _DeltaOp::Skip, _zigzag_encode(static_cast<int64_t>(op.end - op.start)));
+				result_length -= op.end - op.start;
+				cursor = op.end;
+			}
+			else
+			{
+				if (!op.content.empty())
 				{
-					lcs[i][j] = std::max(lcs[i - 1][j], lcs[i][j - 1]);
+					_write_delta_op(body, _DeltaOp::Insert, op.content.length());
+					body.insert(body.end(), op.content.begin(), op.content.end());
 				}
+				result_length += op.content.length();
+				cursor = op.start;
+			}
+		}
+		if (base_length > cursor)
+			_write_delta_op(body, _DeltaOp::Copy, base_length - cursor);
+
+		std::vector<uint8_t> encoded;
+		encoded.reserve(body.size() + 20);
+		_write_varint(encoded, base_length);
+		_write_varint(encoded, result_length);
+		encoded.insert(encoded.end(), body.begin(), body.end());
+		return encoded;
+	}
+
+	/**
+	 * @brief 逐条读取二进制差异的指令
+	 * @param on_copy on_copy(base_offset, length)
+	 * @param on_insert on_insert(base_offset, const char* data, length)
+	 * @param on_skip on_skip(base_offset, offset)，offset为有符号偏移
+	 * @return 头部记录的结果长度
+	 */
+	template<typename OnCopy, typename OnInsert, typename OnSkip>
+	size_t _read_delta(
+		const uint8_t* data, size_t size,
+		size_t base_length,
+		OnCopy&& on_copy,
+		OnInsert&& on_insert,
+		OnSkip&& on_skip)
+	{
+		const uint8_t* end = data + size;
+		if (_read_varint(data, end) != base_length)
+			throw std::invalid_argument("delta does not match base length");
+		const uint64_t result_length = _read_varint(data, end);
+
+		uint64_t cursor = 0;
+		uint64_t produced = 0;
+		while (data != end)
+		{
+			const uint64_t word = _read_varint(data, end);
+			const uint64_t argument = word >> 2;
+			switch (static_cast<_DeltaOp>(word & 3))
+			{
+			case _DeltaOp::Copy:
+				if (argument > base_length - cursor)
+					throw std::invalid_argument("delta copies past the end of base");
+				on_copy(static_cast<size_t>(cursor), static_cast<size_t>(argument));
+				cursor += argument;
+				produced += argument;
+				break;
+			case _DeltaOp::Insert:
+				if (argument > static_cast<uint64_t>(end - data))
+					throw std::invalid_argument("truncated delta");
+				on_insert(static_cast<size_t>(cursor), reinterpret_cast<const char*>(data), static_cast<size_t>(argument));
+				data += argument;
+				produced += argument;
+				break;
+			case _DeltaOp::Skip:
+			{
+				const int64_t offset = _zigzag_decode(argument);
+				if (offset < 0 ? static_cast<uint64_t>(-offset) > cursor : static_cast<uint64_t>(offset) > base_length - cursor)
+					throw std::invalid_argument("delta skips outside of base");
+				on_skip(static_cast<size_t>(cursor), offset);
+				cursor = static_cast<uint64_t>(static_cast<int64_t>(cursor) + offset);
+				break;
+			}
+			default:
+				throw std::invalid_argument("unknown delta instruction");
 			}
+			if (produced > result_length)
+				throw std::invalid_argument("delta exceeds declared result length");
 		}
+		if (produced != result_length)
+			throw std::invalid_argument("delta does not match declared result length");
+		return static_cast<size_t>(result_length);
+	}
 
-		// 基于LCS生成操作序列
+	/**
+	 * @brief 将二进制差异解码为操作序列，删除内容从base中取回
+	 * @param encoded EncodeOperations的输出
+	 * @param base 编码时使用的源字符串
+	 * @return 操作序列
+	 */
+	inline std::vector<StringOperation> DecodeOperations(const std::vector<uint8_t>& encoded, std::string_view base)
+	{
 		std::vector<StringOperation> operations;
-		size_t i = m, j = n;
+		_read_delta(encoded.data(), encoded.size(), base.length(),
+			[](size_t, size_t) {},
+			[&operations](size_t cursor, const char* data, size_t length)
+			{
+				operations.emplace_back(StringOpType::Add, cursor, cursor, std::string(data, length));
+			},
+			[&operations, base](size_t cursor, int64_t offset)
+			{
+				if (offset < 0)
+					throw std::invalid_argument("backward skip cannot be represented as operations");
+				operations.emplace_back(StringOpType::Delete, cursor, cursor + static_cast<size_t>(offset),
+					std::string(base.substr(cursor, static_cast<size_t>(offset))));
+			});
+		return operations;
+	}
+
+	/**
+	 * @brief 直接按二进制差异从base构建结果，不经过操作对象
+	 * base可以是内存映射的文件视图（ToolFileMapping::GetView）
+	 * @param base 编码时使用的源字符串
+	 * @param data 差异数据
+	 * @param size 差异长度
+	 * @return 应用后的字符串
+	 */
+	inline std::string ApplyEncodedDelta(std::string_view base, const uint8_t* data, size_t size)
+	{
+		std::string result;
+		const uint8_t* header = data;
+		const uint8_t* end = data + size;
+		_read_varint(header, end);
+		const uint64_t result_length = _read_varint(header, end);
+		result.reserve(static_cast<size_t>(std::min<uint64_t>(result_length, base.length() + size)));
+		_read_delta(data, size, base.length(),
+			[&result, base](size_t cursor, size_t length) { result.append(base.data() + cursor, length); },
+			[&result](size_t, const char* bytes, size_t length) { result.append(bytes, length); },
+			[](size_t, int64_t) {});
+		return result;
+	}
+
+	inline std::string ApplyEncodedDelta(std::string_view base, const std::vector<uint8_t>& encoded)
+	{
+		return ApplyEncodedDelta(base, encoded.data(), encoded.size());
+	}
+
+	/**
+	 * @brief Adler风格的滚动校验和（rsync弱校验）
+	 * a为窗口内字节之和，b为按距窗口末尾的距离加权的和，窗口右移一个字节时O(1)更新
+	 */
+	class _RollingChecksum
+	{
+	private:
+		uint32_t a = 0;
+		uint32_t b = 0;
+		uint32_t window = 0;
+
+	public:
+		void Reset(const uint8_t* data, size_t length) noexcept
+		{
+			a = 0;
+			b = 0;
+			window = static_cast<uint32_t>(length);
+			for (size_t i = 0; i < length; ++i)
+			{
+				a += data[i];
+				b += a;
+			}
+		}
+		/**
+		 * @brief 移出out、移入in
+		 */
+		void Roll(uint8_t out, uint8_t in) noexcept
+		{
+			a += static_cast<uint32_t>(in) - out;
+			b += a - window * out;
+		}
+		uint32_t Value() const noexcept
+		{
+			return (a & 0xFFFF) | (b << 16);
+		}
+	};
+
+	/**
+	 * @brief 计算base到target的二进制差异（rsync/xdelta风格）
+	 * 把base按block_size切成不重叠的块并以滚动校验和建立索引，逐字节滚动扫描target，
+	 * 校验和命中且内容一致时向前后延伸匹配，输出复制指令，其余字节输出为插入。
+	 * 输出与EncodeOperations相同的格式，复制来源可以向前跳转（负的SKIP），
+	 * 因此能表达块的移动与重复；可用ApplyBinaryDelta或ApplyEncodedDelta还原
+	 * @param base 源数据
+	 * @param base_size 源数据长度
+	 * @param target 目标数据
+	 * @param target_size 目标数据长度
+	 * @param block_size 索引块的字节数，越小差异越细、索引越大
+	 * @return 编码后的差异
+	 */
+	inline std::vector<uint8_t> CreateBinaryDelta(
+		const uint8_t* base, size_t base_size,
+		const uint8_t* target, size_t target_size,
+		size_t block_size = 64)
+	{
+		if (block_size == 0)
+			throw std::invalid_argument("block_size must be positive");
+		constexpr size_t max_candidates = 16;  // 每个位置最多比较的同校验和块数
+
+		// 块索引: 桶头与链表均为块号，按块号递增插入，链表从最近的块开始
+		const size_t block_count = base_size / block_size;
+		if (block_count >= UINT32_MAX)
+			throw std::invalid_argument("base is too large for block_size");
+		int shift = 64;
+		size_t bucket_count = 1;
+		while (bucket_count < block_count * 2)
+		{
+			bucket_count <<= 1;
+			--shift;
+		}
+		auto bucket_of = [shift](uint32_t checksum)
+			{
+				return shift >= 64 ? size_t(0) : static_cast<size_t>((checksum * 0x9E3779B97F4A7C15ULL) >> shift);
+			};
+		std::vector<uint32_t> heads(bucket_count, UINT32_MAX);
+		std::vector<uint32_t> next(block_count);
+		std::vector<uint32_t> checksums(block_count);
+		_RollingChecksum rolling;
+		for (size_t block = 0; block < block_count; ++block)
+		{
+			rolling.Reset(base + block * block_size, block_size);
+			checksums[block] = rolling.Value();
+			const size_t bucket = bucket_of(checksums[block]);
+			next[block] = heads[bucket];
+			heads[bucket] = static_cast<uint32_t>(block);
+		}
+
+		const auto view = [](const uint8_t* data, size_t length)
+			{
+				return std::string_view(reinterpret_cast<const char*>(data), length);
+			};
+		std::vector<uint8_t> body;
+		size_t cursor = 0;        // base游标
+		size_t insert_begin = 0;  // 尚未输出的插入段起点
+		auto flush_insert = [&](size_t end)
+			{
+				if (end > insert_begin)
+				{
+					_write_delta_op(body, _DeltaOp::Insert, end - insert_begin);
+					body.insert(body.end(), target + insert_begin, target + end);
+				}
+			};
+
+		size_t pos = 0;
+		bool rolled = false;  // rolling是否对应target[pos, pos + block_size)
+		while (block_count > 0 && pos + block_size <= target_size)
+		{
+			if (!rolled)
+			{
+				rolling.Reset(target + pos, block_size);
+				rolled = true;
+			}
+
+			// 取向后延伸最长的来源，长度相同时优先接续上一次复制（无需SKIP）
+			size_t best_length = 0, best_offset = 0;
+			auto consider = [&](size_t offset)
+				{
+					if (offset >= base_size)
+						return;
+					const size_t length = _common_prefix_length(view(target + pos, target_size - pos), view(base + offset, base_size - offset));
+					if (length >= block_size && length > best_length)
+					{
+						best_length = length;
+						best_offset = offset;
+					}
+				};
+			// 接续位置: 插入之后（cursor）与等长替换之后（cursor + 插入段长度）；
+			// 低熵数据中大量块校验和相同，只走链表会总是选到base末尾附近的块
+			consider(cursor);
+			consider(cursor + (pos - insert_begin));
+
+			const uint32_t checksum = rolling.Value();
+			size_t checked = 0;
+			for (uint32_t block = heads[bucket_of(checksum)]; block != UINT32_MAX && checked < max_candidates; block = next[block])
+			{
+				if (checksums[block] != checksum)
+					continue;
+				++checked;
+				consider(static_cast<size_t>(block) * block_size);
+			}
+
+			if (best_length == 0)
+			{
+				if (pos + block_size < target_size)
+					rolling.Roll(target[pos], target[pos + block_size]);
+				++pos;
+				continue;
+			}
+
+			// 向前延伸到尚未输出的插入段中
+			const size_t back = _common_suffix_length(view(target + insert_begin, pos - insert_begin), view(base, best_offset));
+			const size_t match_begin = pos - back;
+			const size_t source = best_offset - back;
+			const size_t length = best_length + back;
+
+			flush_insert(match_begin);
+			if (source != cursor)
+				_write_delta_op(body, _DeltaOp::Skip, _zigzag_encode(static_cast<int64_t>(source) - static_cast<int64_t>(cursor)));
+			_write_delta_op(body, _DeltaOp::Copy, length);
+			cursor = source + length;
+			pos = match_begin + length;
+			insert_begin = pos;
+			rolled = false;
+		}
+		flush_insert(target_size);
+
+		std::vector<uint8_t> encoded;
+		encoded.reserve(body.size() + 20);
+		_write_varint(encoded, base_size);
+		_write_varint(encoded, target_size);
+		encoded.insert(encoded.end(), body.begin(), body.end());
+		return encoded;
+	}
+
+	inline std::vector<uint8_t> CreateBinaryDelta(
+		const std::vector<uint8_t>& base,
+		const std::vector<uint8_t>& target,
+		size_t block_size = 64)
+	{
+		return CreateBinaryDelta(base.data(), base.size(), target.data(), target.size(), block_size);
+	}
+
+	/**
+	 * @brief 按二进制差异从base还原目标数据
+	 * @param base 创建差异时使用的源数据
+	 * @param base_size 源数据长度
+	 * @param delta 差异数据
+	 * @param delta_size 差异长度
+	 * @return 目标数据
+	 */
+	inline std::vector<uint8_t> ApplyBinaryDelta(
+		const uint8_t* base, size_t base_size,
+		const uint8_t* delta, size_t delta_size)
+	{
+		const uint8_t* header = delta;
+		const uint8_t* end = delta + delta_size;
+		_read_varint(header, end);
+		const uint64_t result_length = _read_varint(header, end);
+
+		// 复制可以重复引用base，结果长度可能超过base与差异之和，按头部声明预留但设置上限
+		std::vector<uint8_t> result;
+		result.reserve(static_cast<size_t>(std::min<uint64_t>(result_length, (base_size + delta_size) * 4)));
+		_read_delta(delta, delta_size, base_size,
+			[&result, base](size_t cursor, size_t length) { result.insert(result.end(), base + cursor, base + cursor + length); },
+			[&result](size_t, const char* bytes, size_t length)
+			{
+				const auto* data = reinterpret_cast<const uint8_t*>(bytes);
+				result.insert(result.end(), data, data + length);
+			},
+			[](size_t, int64_t) {});
+		return result;
+	}
+
+	inline std::vector<uint8_t> ApplyBinaryDelta(const std::vector<uint8_t>& base, const std::vector<uint8_t>& delta)
+	{
+		return ApplyBinaryDelta(base.data(), base.size(), delta.data(), delta.size());
+	}
+
+	/**
+	 * @brief LCS回溯路径上的一步
+	 */
+	enum class _EditStep : uint8_t
+	{
+		Match,   // s1[i]与s2[j]匹配
+		Add,     // 插入s2[j]
+		Delete   // 删除s1[i]
+	};
 
+	/**
+	 * @brief 从LCS表回溯编辑路径（逆序，每步一个字节）
+	 * 平局时优先插入，与原有回溯规则一致
+	 * @param lcs_at 读取LCS表的函数lcs_at(i, j)
+	 */
+	template<typename LCSAt>
+	std::vector<_EditStep> _backtrack_lcs_path(std::string_view s1, std::string_view s2, LCSAt&& lcs_at)
+	{
+		std::vector<_EditStep> steps;
+		steps.reserve(s1.length() + s2.length());
+		size_t i = s1.length(), j = s2.length();
 		while (i > 0 || j > 0)
 		{
 			if (i > 0 && j > 0 && s1[i - 1] == s2[j - 1])
 			{
-				// 字符匹配，不需要操作
+				steps.push_back(_EditStep::Match);
 				--i;
 				--j;
 			}
-			else if (j > 0 && (i == 0 || lcs[i][j - 1] >= lcs[i - 1][j]))
+			else if (j > 0 && (i == 0 || lcs_at(i, j - 1) >= lcs_at(i - 1, j)))
 			{
-				// 需要插入s2[j-1]
-				size_t insert_pos = i;
-				operations.insert(operations.begin(),
-					StringOperation(StringOpType::Add, insert_pos, insert_pos, std::string(1, s2[j - 1])));
+				steps.push_back(_EditStep::Add);
 				--j;
 			}
 			else
 			{
-				// 需要删除s1[i-1]
-				operations.insert(operations.begin(),
-					StringOperation(StringOpType::Delete, i - 1, i, std::string(1, s1[i - 1])));
+				steps.push_back(_EditStep::Delete);
 				--i;
 			}
 		}
+		return steps;
+	}
 
-		// 合并连续的操作
-		std::vector<StringOperation> merged_operations;
-		for (const auto& op : operations)
+	/**
+	 * @brief 按正序重放逆序编辑路径，相邻的同类操作合并后逐个交给回调
+	 * @param callback 接收StringOperationRef&&，content引用s1（删除）或s2（添加）
+	 */
+	template<typename Callback>
+	void _replay_lcs_path(std::string_view s1, std::string_view s2, const std::vector<_EditStep>& steps, Callback&& callback)
+	{
+		std::optional<StringOperationRef> pending;
+		auto flush = [&]()
+			{
+				if (pending)
+				{
+					callback(std::move(*pending));
+					pending.reset();
+				}
+			};
+
+		size_t i = 0, j = 0;
+		for (auto iter = steps.rbegin(); iter != steps.rend(); ++iter)
 		{
-			if (!merged_operations.empty() && merged_operations.back().type == op.type)
+			switch (*iter)
 			{
-				auto& last_op = merged_operations.back();
-				if (op.type == StringOpType::Add && last_op.end == op.start)
+			case _EditStep::Match:
+				flush();
+				++i;
+				++j;
+				break;
+			case _EditStep::Add:
+				if (pending && pending->type == StringOpType::Add && pending->start == i)
+					pending->content = std::string_view(pending->content.data(), pending->content.length() + 1);
+				else
 				{
-					// 合并连续的添加操作
-					last_op.end = op.end;
-					last_op.content += op.content;
+					flush();
+					pending.emplace(StringOpType::Add, i, i, s2.substr(j, 1));
 				}
-				else if (op.type == StringOpType::Delete && last_op.end == op.start)
+				++j;
+				break;
+			case _EditStep::Delete:
+				if (pending && pending->type == StringOpType::Delete && pending->end == i)
 				{
-					// 合并连续的删除操作
-					last_op.end = op.end;
-					last_op.content += op.content;
+					pending->end = i + 1;
+					pending->content = std::string_view(pending->content.data(), pending->content.length() + 1);
 				}
 				else
 				{
-					merged_operations.push_back(op);
+					flush();
+					pending.emplace(StringOpType::Delete, i, i + 1, s1.substr(i, 1));
 				}
+				++i;
+				break;
 			}
-			else
+		}
+		flush();
+	}
+
+	/**
+	 * @brief 计算两个字符串的编辑距离和操作序列
+	 * 使用LCS算法来找到最长公共子序列，然后基于LCS生成操作序列
+	 * 操作按位置顺序逐个交给回调，不构建操作数组
+	 * @param s1 源字符串
+	 * @param s2 目标字符串
+	 * @param callback 接收操作的回调（按位置顺序调用）
+	 * @return 编辑距离
+	 */
+	inline int GetEditorDistanceAndOperations(
+		const std::string& s1,
+		const std::string& s2,
+		const std::function<void(StringOperation&&)>& callback)
+	{
+		size_t m = s1.length();
+		size_t n = s2.length();
+
+		// 使用LCS算法构建动态规划表
+		std::vector<std::vector<int>> lcs(m + 1, std::vector<int>(n + 1, 0));
+
+		// 构建LCS表
+		for (size_t i = 1; i <= m; ++i)
+		{
+			for (size_t j = 1; j <= n; ++j)
 			{
-				merged_operations.push_back(op);
+				if (s1[i - 1] == s2[j - 1])
+				{
+					lcs[i][j] = lcs[i - 1][j - 1] + 1;
+				}
+				else
+				{
+					lcs[i][j] = std::max(lcs[i - 1][j], lcs[i][j - 1]);
+				}
 			}
 		}
 
+		// 回溯路径后正序生成操作
+		auto steps = _backtrack_lcs_path(s1, s2, [&lcs](size_t i, size_t j) { return lcs[i][j]; });
+		_replay_lcs_path(s1, s2, steps,
+			[&callback](StringOperationRef&& op) { callback(op.ToOperation()); });
+
 		// 计算编辑距离
-		int edit_distance = static_cast<int>(m + n - 2 * lcs[m][n]);
-		return { edit_distance, merged_operations };
+		return static_cast<int>(m + n - 2 * lcs[m][n]);
+	}
+
+	/**
+	 * @brief 计算两个字符串的编辑距离和操作序列
+	 * 使用LCS算法来找到最长公共子序列，然后基于LCS生成操作序列
+	 * @param s1 源字符串
+	 * @param s2 目标字符串
+	 * @return (编辑距离, 操作序列)
+	 */
+	inline std::pair<int, std::vector<StringOperation>> GetEditorDistanceAndOperations(
+		const std::string& s1,
+		const std::string& s2)
+	{
+		std::vector<StringOperation> operations;
+		int edit_distance = GetEditorDistanceAndOperations(s1, s2,
+			[&operations](StringOperation&& op) { operations.push_back(std::move(op)); });
+		return { edit_distance, std::move(operations) };
 	}
 
 	/**
@@ -330,9 +1578,10 @@ namespace Convention
 	 * @param lines2 目标字符串行数组
 	 * @return LCS动态规划表
 	 */
-	inline std::vector<std::vector<int>> _build_line_lcs(
-		const std::vector<std::string>& lines1,
-		const std::vector<std::string>& lines2)
+	template<typename Line>
+	std::vector<std::vector<int>> _build_line_lcs_impl(
+		const std::vector<Line>& lines1,
+		const std::vector<Line>& lines2)
 	{
 		size_t m = lines1.size();
 		size_t n = lines2.size();
@@ -343,7 +1592,7 @@ namespace Convention
 		hash1.reserve(m);
 		hash2.reserve(n);
 
-		std::hash<std::string> hasher;
+		std::hash<std::string_view> hasher;
 		for (const auto& line : lines1)
 			hash1.push_back(hasher(line));
 		for (const auto& line : lines2)
@@ -367,6 +1616,20 @@ namespace Convention
 		return lcs;
 	}
 
+	inline std::vector<std::vector<int>> _build_line_lcs(
+		const std::vector<std::string>& lines1,
+		const std::vector<std::string>& lines2)
+	{
+		return _build_line_lcs_impl(lines1, lines2);
+	}
+
+	inline std::vector<std::vector<int>> _build_line_lcs(
+		const std::vector<std::string_view>& lines1,
+		const std::vector<std::string_view>& lines2)
+	{
+		return _build_line_lcs_impl(lines1, lines2);
+	}
+
 	/**
 	 * @brief 行级操作结构
 	 */
@@ -394,6 +1657,7 @@ namespace Convention
 		const std::vector<std::string>& lines2,
 		const std::vector<std::vector<int>>& lcs)
 	{
+		// 回溯得到逆序的操作，同类相邻的行直接并入，最后整体反转
 		std::vector<LineOperation> operations;
 		size_t m = lines1.size();
 		size_t n = lines2.size();
@@ -408,290 +1672,3658 @@ namespace Convention
 			}
 			else if (j > 0 && (i == 0 || lcs[i][j - 1] >= lcs[i - 1][j]))
 			{
-				std::vector<std::string> temp_lines = { lines2[j - 1] };
-				operations.insert(operations.begin(),
-					LineOperation(StringOpType::Add, i, i, std::move(temp_lines)));
+				if (!operations.empty() && operations.back().type == StringOpType::Add && operations.back().start_line == i)
+					operations.back().lines.push_back(lines2[j - 1]);
+				else
+					operations.emplace_back(StringOpType::Add, i, i, std::vector<std::string>{ lines2[j - 1] });
 				--j;
 			}
 			else
 			{
-				std::vector<std::string> temp_lines = { lines1[i - 1] };
-				operations.insert(operations.begin(),
-					LineOperation(StringOpType::Delete, i - 1, i, std::move(temp_lines)));
+				if (!operations.empty() && operations.back().type == StringOpType::Delete && operations.back().start_line == i)
+				{
+					operations.back().start_line = i - 1;
+					operations.back().lines.push_back(lines1[i - 1]);
+				}
+				else
+					operations.emplace_back(StringOpType::Delete, i - 1, i, std::vector<std::string>{ lines1[i - 1] });
 				--i;
 			}
 		}
 
-		// 合并连续的同类行操作
-		std::vector<LineOperation> merged;
+		// 各操作内的行也是逆序收集的
+		std::reverse(operations.begin(), operations.end());
 		for (auto& op : operations)
-		{
-			if (!merged.empty() && merged.back().type == op.type && merged.back().end_line == op.start_line)
-			{
-				merged.back().end_line = op.end_line;
-				merged.back().lines.insert(merged.back().lines.end(),
-					op.lines.begin(), op.lines.end());
-			}
-			else
-			{
-				merged.push_back(std::move(op));
-			}
-		}
-
-		return merged;
+			std::reverse(op.lines.begin(), op.lines.end());
+		return operations;
 	}
 
 	/**
-	 * @brief 对小范围区域进行字符级LCS比较
-	 * @param s1 源字符串
-	 * @param s2 目标字符串
-	 * @return 操作序列（相对于输入字符串的位置）
+	 * @brief 引用源文本的行级操作
+	 * content为[start_line, end_line)（删除）或添加的各行在所在文本中的连续区域，
+	 * 行之间以'\n'分隔，末尾不含换行符
 	 */
-	inline std::vector<StringOperation> _char_diff_in_region(
-		const std::string& s1,
-		const std::string& s2)
+	struct LineOperationRef
 	{
-		size_t m = s1.length();
-		size_t n = s2.length();
-
-		// 快速路径
-		if (m == 0 && n == 0)
-			return {};
-		if (m == 0)
-			return { StringOperation(StringOpType::Add, 0, 0, s2) };
-		if (n == 0)
-			return { StringOperation(StringOpType::Delete, 0, m, s1) };
-		if (s1 == s2)
-			return {};
+		StringOpType type;          // 操作类型
+		size_t start_line;          // 起始行号
+		size_t end_line;            // 结束行号
+		std::string_view content;   // 行内容（引用）
 
-		// 字符级LCS
-		std::vector<std::vector<int>> lcs(m + 1, std::vector<int>(n + 1, 0));
+		LineOperationRef(StringOpType t, size_t s, size_t e, std::string_view c)
+			: type(t), start_line(s), end_line(e), content(c) {
+		}
 
-		for (size_t i = 1; i <= m; ++i)
+		/**
+		 * @brief 复制内容，得到独立的行级操作
+		 */
+		LineOperation ToOperation() const
 		{
-			for (size_t j = 1; j <= n; ++j)
+			std::vector<std::string> lines;
+			size_t begin = 0;
+			while (true)
 			{
-				if (s1[i - 1] == s2[j - 1])
-				{
-					lcs[i][j] = lcs[i - 1][j - 1] + 1;
-				}
-				else
-				{
-					lcs[i][j] = std::max(lcs[i - 1][j], lcs[i][j - 1]);
-				}
+				const size_t pos = content.find('\n', begin);
+				lines.emplace_back(content.substr(begin, pos == std::string_view::npos ? std::string_view::npos : pos - begin));
+				if (pos == std::string_view::npos)
+					break;
+				begin = pos + 1;
 			}
+			return LineOperation(type, start_line, end_line, std::move(lines));
 		}
+	};
 
-		// 回溯生成操作
-		std::vector<StringOperation> operations;
-		size_t i = m, j = n;
+	/**
+	 * @brief 从LCS表提取引用形式的行级操作序列
+	 * 回溯规则与_extract_line_operations相同；各行必须由_split_lines_view从同一文本分出
+	 * @param lines1 源文本行数组
+	 * @param lines2 目标文本行数组
+	 * @param lcs LCS动态规划表
+	 * @return 行级操作序列
+	 */
+	inline std::vector<LineOperationRef> _extract_line_operations(
+		const std::vector<std::string_view>& lines1,
+		const std::vector<std::string_view>& lines2,
+		const std::vector<std::vector<int>>& lcs)
+	{
+		// 第first到last行（含）在所在文本中的连续区域
+		auto region = [](const std::vector<std::string_view>& lines, size_t first, size_t last)
+			{
+				return std::string_view(lines[first].data(), lines[last].data() + lines[last].size() - lines[first].data());
+			};
 
+		// 回溯得到逆序的单行操作，同类相邻的行直接并入
+		std::vector<LineOperationRef> operations;
+		size_t add_last = 0;  // 当前添加操作最后一行在lines2中的下标
+		size_t i = lines1.size(), j = lines2.size();
 		while (i > 0 || j > 0)
 		{
-			if (i > 0 && j > 0 && s1[i - 1] == s2[j - 1])
+			if (i > 0 && j > 0 && lines1[i - 1] == lines2[j - 1])
 			{
 				--i;
 				--j;
 			}
 			else if (j > 0 && (i == 0 || lcs[i][j - 1] >= lcs[i - 1][j]))
 			{
-				operations.insert(operations.begin(),
-					StringOperation(StringOpType::Add, i, i, std::string(1, s2[j - 1])));
+				if (!operations.empty() && operations.back().type == StringOpType::Add && operations.back().start_line == i)
+					operations.back().content = region(lines2, j - 1, add_last);
+				else
+				{
+					operations.emplace_back(StringOpType::Add, i, i, lines2[j - 1]);
+					add_last = j - 1;
+				}
 				--j;
 			}
 			else
 			{
-				operations.insert(operations.begin(),
-					StringOperation(StringOpType::Delete, i - 1, i, std::string(1, s1[i - 1])));
+				if (!operations.empty() && operations.back().type == StringOpType::Delete && operations.back().start_line == i)
+				{
+					operations.back().start_line = i - 1;
+					operations.back().content = region(lines1, i - 1, operations.back().end_line - 1);
+				}
+				else
+					operations.emplace_back(StringOpType::Delete, i - 1, i, lines1[i - 1]);
 				--i;
 			}
 		}
+		std::reverse(operations.begin(), operations.end());
+		return operations;
+	}
 
-		// 合并连续操作
-		std::vector<StringOperation> merged;
-		for (const auto& op : operations)
+	/**
+	 * @brief 公共子序列匹配段
+	 * 表示源序列[a, a + length)与目标序列[b, b + length)逐元素相等
+	 */
+	struct _DiffMatch
+	{
+		size_t a;       // 源序列起始下标
+		size_t b;       // 目标序列起始下标
+		size_t length;  // 匹配长度
+	};
+
+	/**
+	 * @brief 追加匹配段，与上一段首尾相接时直接合并
+	 */
+	inline void _push_diff_match(std::vector<_DiffMatch>& matches, size_t a, size_t b, size_t length)
+	{
+		if (length == 0)
+			return;
+		if (!matches.empty() &&
+			matches.back().a + matches.back().length == a &&
+			matches.back().b + matches.back().length == b)
+		{
+			matches.back().length += length;
+			return;
+		}
+		matches.push_back({ a, b, length });
+	}
+
+	/**
+	 * @brief Myers中间蛇查找（正反两个方向同时推进，只保留两条V数组）
+	 * 调用前需保证a与b均非空且首尾元素不相等
+	 * @param work 复用的工作缓冲区，避免递归中反复分配
+	 * @param split_x 输出: 分割点在a中的位置
+	 * @param split_y 输出: 分割点在b中的位置
+	 * @return 是否找到分割点，false表示两段没有任何公共元素
+	 */
+	template<typename T>
+	bool _myers_bisect(
+		const T* a, ptrdiff_t n,
+		const T* b, ptrdiff_t m,
+		std::vector<ptrdiff_t>& work,
+		ptrdiff_t& split_x,
+		ptrdiff_t& split_y)
+	{
+		const ptrdiff_t max_d = (n + m + 1) / 2;
+		const ptrdiff_t v_offset = max_d;
+		const ptrdiff_t v_length = 2 * max_d + 2;
+		work.assign(static_cast<size_t>(2 * v_length), -1);
+		ptrdiff_t* v1 = work.data();
+		ptrdiff_t* v2 = work.data() + v_length;
+		v1[v_offset + 1] = 0;
+		v2[v_offset + 1] = 0;
+
+		const ptrdiff_t delta = n - m;
+		// 差值为奇数时正向路径先与反向路径重叠
+		const bool front = (delta % 2 != 0);
+		ptrdiff_t k1start = 0, k1end = 0, k2start = 0, k2end = 0;
+
+		for (ptrdiff_t d = 0; d < max_d; ++d)
 		{
-			if (!merged.empty() && merged.back().type == op.type)
+			// 正向推进
+			for (ptrdiff_t k1 = -d + k1start; k1 <= d - k1end; k1 += 2)
 			{
-				auto& last_op = merged.back();
-				if (op.type == StringOpType::Add && last_op.end == op.start)
+				const ptrdiff_t k1_offset = v_offset + k1;
+				ptrdiff_t x1;
+				if (k1 == -d || (k1 != d && v1[k1_offset - 1] < v1[k1_offset + 1]))
+					x1 = v1[k1_offset + 1];
+				else
+					x1 = v1[k1_offset - 1] + 1;
+				ptrdiff_t y1 = x1 - k1;
+				while (x1 < n && y1 < m && a[x1] == b[y1])
 				{
-					last_op.end = op.end;
-					last_op.content += op.content;
+					++x1;
+					++y1;
 				}
-				else if (op.type == StringOpType::Delete && last_op.end == op.start)
+				v1[k1_offset] = x1;
+				if (x1 > n)
 				{
-					last_op.end = op.end;
-					last_op.content += op.content;
+					k1end += 2;
 				}
-				else
+				else if (y1 > m)
 				{
-					merged.push_back(op);
+					k1start += 2;
+				}
+				else if (front)
+				{
+					const ptrdiff_t k2_offset = v_offset + delta - k1;
+					if (k2_offset >= 0 && k2_offset < v_length && v2[k2_offset] != -1)
+					{
+						if (x1 >= n - v2[k2_offset])
+						{
+							split_x = x1;
+							split_y = y1;
+							return true;
+						}
+					}
 				}
 			}
-			else
+
+			// 反向推进
+			for (ptrdiff_t k2 = -d + k2start; k2 <= d - k2end; k2 += 2)
 			{
-				merged.push_back(op);
+				const ptrdiff_t k2_offset = v_offset + k2;
+				ptrdiff_t x2;
+				if (k2 == -d || (k2 != d && v2[k2_offset - 1] < v2[k2_offset + 1]))
+					x2 = v2[k2_offset + 1];
+				else
+					x2 = v2[k2_offset - 1] + 1;
+				ptrdiff_t y2 = x2 - k2;
+				while (x2 < n && y2 < m && a[n - x2 - 1] == b[m - y2 - 1])
+				{
+					++x2;
+					++y2;
+				}
+				v2[k2_offset] = x2;
+				if (x2 > n)
+				{
+					k2end += 2;
+				}
+				else if (y2 > m)
+				{
+					k2start += 2;
+				}
+				else if (!front)
+				{
+					const ptrdiff_t k1_offset = v_offset + delta - k2;
+					if (k1_offset >= 0 && k1_offset < v_length && v1[k1_offset] != -1)
+					{
+						const ptrdiff_t x1 = v1[k1_offset];
+						const ptrdiff_t y1 = v_offset + x1 - k1_offset;
+						if (x1 >= n - x2)
+						{
+							split_x = x1;
+							split_y = y1;
+							return true;
+						}
+					}
+				}
 			}
 		}
-
-		return merged;
+		return false;
 	}
 
 	/**
-	 * @brief 分割字符串为行数组
-	 * @param s 输入字符串
-	 * @return 行数组
+	 * @brief Myers O((N+M)D) 差异算法（线性空间中间蛇分治）
+	 * 在a[a_lo, a_hi)与b[b_lo, b_hi)上求最长公共子序列，按顺序追加匹配段
+	 * @param matches 输出: 匹配段列表
+	 * @param work 复用的工作缓冲区
 	 */
-	inline std::vector<std::string> _split_lines(const std::string& s)
+	template<typename T>
+	void _myers_diff(
+		const T* a, size_t a_lo, size_t a_hi,
+		const T* b, size_t b_lo, size_t b_hi,
+		std::vector<_DiffMatch>& matches,
+		std::vector<ptrdiff_t>& work)
 	{
-		std::vector<std::string> lines;
-		size_t start = 0;
-		size_t pos = 0;
+		// 剥离公共前缀
+		size_t prefix = 0;
+		while (a_lo + prefix < a_hi && b_lo + prefix < b_hi && a[a_lo + prefix] == b[b_lo + prefix])
+			++prefix;
+		_push_diff_match(matches, a_lo, b_lo, prefix);
+		a_lo += prefix;
+		b_lo += prefix;
 
-		while ((pos = s.find('\n', start)) != std::string::npos)
+		// 剥离公共后缀
+		size_t suffix = 0;
+		while (a_lo + suffix < a_hi && b_lo + suffix < b_hi && a[a_hi - suffix - 1] == b[b_hi - suffix - 1])
+			++suffix;
+		a_hi -= suffix;
+		b_hi -= suffix;
+
+		if (a_lo < a_hi && b_lo < b_hi)
 		{
-			lines.push_back(s.substr(start, pos - start));
-			start = pos + 1;
+			ptrdiff_t x = 0, y = 0;
+			if (_myers_bisect(
+				a + a_lo, static_cast<ptrdiff_t>(a_hi - a_lo),
+				b + b_lo, static_cast<ptrdiff_t>(b_hi - b_lo),
+				work, x, y))
+			{
+				_myers_diff(a, a_lo, a_lo + x, b, b_lo, b_lo + y, matches, work);
+				_myers_diff(a, a_lo + x, a_hi, b, b_lo + y, b_hi, matches, work);
+			}
 		}
 
-		// 添加最后一行（即使为空）
-		lines.push_back(s.substr(start));
+		_push_diff_match(matches, a_hi, b_hi, suffix);
+	}
 
-		return lines;
+	/**
+	 * @brief 将两组行映射为整数编号，内容相同的行编号相同
+	 * @param lines1 源字符串行数组
+	 * @param lines2 目标字符串行数组
+	 * @param ids1 输出: 源行编号
+	 * @param ids2 输出: 目标行编号
+	 */
+	inline void _intern_lines(
+		const std::vector<std::string>& lines1,
+		const std::vector<std::string>& lines2,
+		std::vector<uint32_t>& ids1,
+		std::vector<uint32_t>& ids2)
+	{
+		std::unordered_map<std::string_view, uint32_t> table;
+		table.reserve(lines1.size() + lines2.size());
+		auto intern = [&table](const std::vector<std::string>& lines, std::vector<uint32_t>& ids)
+			{
+				ids.clear();
+				ids.reserve(lines.size());
+				for (const auto& line : lines)
+				{
+					auto [iter, inserted] = table.try_emplace(line, static_cast<uint32_t>(table.size()));
+					ids.push_back(iter->second);
+				}
+			};
+		intern(lines1, ids1);
+		intern(lines2, ids2);
 	}
 
 	/**
-	 * @brief 连接字符串数组为单个字符串
-	 * @param lines 字符串数组
-	 * @param separator 分隔符（默认换行符）
-	 * @return 连接后的字符串
+	 * @brief 行级差异算法
 	 */
-	inline std::string _join_lines(const std::vector<std::string>& lines, const std::string& separator = "\n")
+	enum class DiffAlgorithm
 	{
-		if (lines.empty())
-			return "";
+		Myers,      // Myers O((N+M)D)线性空间算法（默认）
+		LCS,        // 完整LCS动态规划表（O(mn)内存，与旧版相同的对齐方式）
+		Patience,   // 以两侧均只出现一次的行为锚点，缝隙内递归
+		Histogram   // 以出现次数最少的公共行为锚点，缝隙内递归
+	};
 
-		std::string result = lines[0];
-		for (size_t i = 1; i < lines.size(); ++i)
-		{
-			result += separator + lines[i];
-		}
-		return result;
-	}
+	/**
+	 * @brief 行内差异的分词方式
+	 */
+	enum class DiffTokenizer
+	{
+		None,        // 不分词，直接进行字符级细化
+		Whitespace,  // 连续的空白、连续的非空白各为一个词
+		Identifier,  // 标识符（字母、数字、下划线与非ASCII字节）与连续的空白各为一个词，其余符号单独成词
+		Custom       // 由DiffOptions::custom_tokenizer决定
+	};
 
 	/**
-	 * @brief 计算两个字符串的差异操作序列（混合行级+字符级算法）
-	 * 操作格式: (操作类型, 开始位置, 结束位置, 内容)
-	 * 位置基于源字符串s1的字符偏移
-	 * @param s1 源字符串
-	 * @param s2 目标字符串
-	 * @return 差异操作序列
+	 * @brief GetDiffOperations的可选参数
 	 */
-	inline std::vector<StringOperation> GetDiffOperations(
-		const std::string& s1,
-		const std::string& s2)
+	struct DiffOptions
 	{
-		// 快速路径
-		if (s1 == s2)
-			return {};
-		if (s1.empty())
-			return { StringOperation(StringOpType::Add, 0, 0, s2) };
-		if (s2.empty())
-			return { StringOperation(StringOpType::Delete, 0, s1.length(), s1) };
+		DiffAlgorithm algorithm = DiffAlgorithm::Myers;  // 行级差异算法
+		size_t histogram_max_chain = 64;                 // Histogram中出现次数超过该值的行不作为锚点
+		size_t streaming_window_lines = 65536;           // 流式比较时每侧窗口的最大行数
+		size_t thread_count = 1;                         // GetDiffOperations的工作线程数，0为硬件线程数
+		bool utf8 = false;                               // 字符级细化按UTF-8码点进行，不拆分多字节字符
+		DiffTokenizer tokenizer = DiffTokenizer::None;   // 不为None时行内差异以词为单位，整词删除/添加
+		std::function<size_t(std::string_view, size_t)> custom_tokenizer;  // Custom分词: 返回从pos开始的词长
+		// 行内细化的最大规模(删除字节数×添加字节数)，超过时不做字符/词级细化而整块删除/添加，
+		// 使流式比较等场景中单个大差异块的时间与内存保持为O(m + n)
+		size_t char_table_max_cells = default_char_table_max_cells;
 
-		// 阶段1: 分行并建立位置映射
-		std::vector<std::string> lines1 = _split_lines(s1);
-		std::vector<std::string> lines2 = _split_lines(s2);
+		static constexpr size_t default_char_table_max_cells = size_t(1) << 24;
 
-		// 构建行号到字符位置的映射
-		std::vector<size_t> line_offsets_s1 = { 0 };
-		for (size_t i = 0; i < lines1.size() - 1; ++i)
+		DiffOptions() = default;
+		DiffOptions(DiffAlgorithm algorithm) : algorithm(algorithm) {}
+	};
+
+	/**
+	 * @brief 求在[a_lo, a_hi)与[b_lo, b_hi)中都恰好出现一次的元素，
+	 * 并取其b坐标的最长递增子序列，得到互不交叉的锚点
+	 * @return 按位置递增排列的(a位置, b位置)
+	 */
+	template<typename T>
+	std::vector<std::pair<size_t, size_t>> _unique_common_anchors(
+		const T* a, size_t a_lo, size_t a_hi,
+		const T* b, size_t b_lo, size_t b_hi)
+	{
+		// 统计两侧出现次数，记录唯一出现的位置
+		struct Occurrence
+		{
+			size_t count_a = 0;
+			size_t count_b = 0;
+			size_t pos_a = 0;
+			size_t pos_b = 0;
+		};
+		std::unordered_map<T, Occurrence> table;
+		table.reserve(a_hi - a_lo);
+		for (size_t i = a_lo; i < a_hi; ++i)
+		{
+			auto& entry = table[a[i]];
+			++entry.count_a;
+			entry.pos_a = i;
+		}
+		for (size_t j = b_lo; j < b_hi; ++j)
 		{
-			line_offsets_s1.push_back(line_offsets_s1.back() + lines1[i].length() + 1); // +1 for '\n'
+			auto iter = table.find(b[j]);
+			if (iter != table.end())
+			{
+				++iter->second.count_b;
+				iter->second.pos_b = j;
+			}
+		}
+
+		// 按a中的顺序收集唯一公共元素
+		std::vector<std::pair<size_t, size_t>> uniques;
+		for (size_t i = a_lo; i < a_hi; ++i)
+		{
+			const auto& entry = table[a[i]];
+			if (entry.count_a == 1 && entry.count_b == 1)
+				uniques.emplace_back(i, entry.pos_b);
 		}
+		std::unordered_map<T, Occurrence>().swap(table);
+		if (uniques.empty())
+			return uniques;
 
-		std::vector<size_t> line_offsets_s2 = { 0 };
-		for (size_t i = 0; i < lines2.size() - 1; ++i)
+		// 耐心排序求b坐标的最长递增子序列
+		std::vector<size_t> tails;                      // 各长度递增序列末尾在uniques中的下标
+		std::vector<size_t> previous(uniques.size());   // 回溯链
+		for (size_t k = 0; k < uniques.size(); ++k)
 		{
-			line_offsets_s2.push_back(line_offsets_s2.back() + lines2[i].length() + 1);
+			auto iter = std::lower_bound(tails.begin(), tails.end(), uniques[k].second,
+				[&uniques](size_t index, size_t value) { return uniques[index].second < value; });
+			previous[k] = (iter == tails.begin()) ? SIZE_MAX : *(iter - 1);
+			if (iter == tails.end())
+				tails.push_back(k);
+			else
+				*iter = k;
 		}
+		std::vector<std::pair<size_t, size_t>> anchors;
+		for (size_t k = tails.back(); k != SIZE_MAX; k = previous[k])
+			anchors.push_back(uniques[k]);
+		std::reverse(anchors.begin(), anchors.end());
+		return anchors;
+	}
 
-		// 阶段2: 行级LCS分析
-		auto lcs = _build_line_lcs(lines1, lines2);
-		auto line_operations = _extract_line_operations(lines1, lines2, lcs);
+	/**
+	 * @brief Patience差异算法
+	 * 以在两段中都恰好出现一次的元素为候选，取其最长递增子序列为锚点，
+	 * 锚点之间的缝隙递归处理；缝隙中没有唯一元素时交给Myers算法
+	 */
+	template<typename T>
+	void _patience_diff(
+		const T* a, size_t a_lo, size_t a_hi,
+		const T* b, size_t b_lo, size_t b_hi,
+		std::vector<_DiffMatch>& matches,
+		std::vector<ptrdiff_t>& work)
+	{
+		size_t prefix = 0;
+		while (a_lo + prefix < a_hi && b_lo + prefix < b_hi && a[a_lo + prefix] == b[b_lo + prefix])
+			++prefix;
+		_push_diff_match(matches, a_lo, b_lo, prefix);
+		a_lo += prefix;
+		b_lo += prefix;
 
-		// 阶段3: 转换为字符级操作
-		std::vector<StringOperation> final_operations;
+		size_t suffix = 0;
+		while (a_lo + suffix < a_hi && b_lo + suffix < b_hi && a[a_hi - suffix - 1] == b[b_hi - suffix - 1])
+			++suffix;
+		a_hi -= suffix;
+		b_hi -= suffix;
 
-		for (const auto& line_op : line_operations)
+		if (a_lo < a_hi && b_lo < b_hi)
 		{
-			if (line_op.type == StringOpType::Add)
+			auto anchors = _unique_common_anchors(a, a_lo, a_hi, b, b_lo, b_hi);
+			if (anchors.empty())
 			{
-				// 添加操作: 在s1的start_line位置插入
-				size_t char_pos = (line_op.start_line < line_offsets_s1.size())
-					? line_offsets_s1[line_op.start_line]
-					: s1.length();
-				std::string content = _join_lines(line_op.lines);
-
-				final_operations.emplace_back(StringOpType::Add, char_pos, char_pos, content);
+				_myers_diff(a, a_lo, a_hi, b, b_lo, b_hi, matches, work);
 			}
-			else if (line_op.type == StringOpType::Delete)
+			else
 			{
-				// 删除操作: 删除s1的[start_line, end_line)行
-				size_t char_start = line_offsets_s1[line_op.start_line];
-				size_t char_end = (line_op.end_line < lines1.size())
-					? line_offsets_s1[line_op.end_line]
-					: s1.length();
-
-				std::string content = _join_lines(line_op.lines);
-				final_operations.emplace_back(StringOpType::Delete, char_start, char_end, content);
+				size_t prev_a = a_lo, prev_b = b_lo;
+				for (const auto& [pos_a, pos_b] : anchors)
+				{
+					_patience_diff(a, prev_a, pos_a, b, prev_b, pos_b, matches, work);
+					_push_diff_match(matches, pos_a, pos_b, 1);
+					prev_a = pos_a + 1;
+					prev_b = pos_b + 1;
+				}
+				_patience_diff(a, prev_a, a_hi, b, prev_b, b_hi, matches, work);
 			}
 		}
 
-		// 阶段4: 对于连续的删除+添加，尝试字符级精细比较
-		std::vector<StringOperation> optimized_operations;
-		size_t i = 0;
+		_push_diff_match(matches, a_hi, b_hi, suffix);
+	}
+
+	/**
+	 * @brief Histogram差异算法
+	 * 在a段中统计各元素出现次数，选取出现次数最少（同等时最长）的公共区域为锚点，
+	 * 锚点两侧递归处理；只剩高频元素时交给Myers算法
+	 * @param max_chain 出现次数超过该值的元素不作为锚点
+	 */
+	template<typename T>
+	void _histogram_diff(
+		const T* a, size_t a_lo, size_t a_hi,
+		const T* b, size_t b_lo, size_t b_hi,
+		size_t max_chain,
+		std::vector<_DiffMatch>& matches,
+		std::vector<ptrdiff_t>& work)
+	{
+		size_t prefix = 0;
+		while (a_lo + prefix < a_hi && b_lo + prefix < b_hi && a[a_lo + prefix] == b[b_lo + prefix])
+			++prefix;
+		_push_diff_match(matches, a_lo, b_lo, prefix);
+		a_lo += prefix;
+		b_lo += prefix;
+
+		size_t suffix = 0;
+		while (a_lo + suffix < a_hi && b_lo + suffix < b_hi && a[a_hi - suffix - 1] == b[b_hi - suffix - 1])
+			++suffix;
+		a_hi -= suffix;
+		b_hi -= suffix;
 
-		while (i < final_operations.size())
+		if (a_lo < a_hi && b_lo < b_hi)
 		{
-			if (i + 1 < final_operations.size() &&
-				final_operations[i].type == StringOpType::Delete &&
-				final_operations[i + 1].type == StringOpType::Add &&
-				final_operations[i].end == final_operations[i + 1].start)
+			// 元素 -> (a中首次出现位置, 出现次数)，同一元素的各位置通过next_same串成升序链
+			std::unordered_map<T, std::pair<size_t, size_t>> histogram;
+			histogram.reserve(a_hi - a_lo);
+			std::vector<size_t> next_same(a_hi - a_lo, SIZE_MAX);
+			for (size_t i = a_hi; i-- > a_lo;)
 			{
-				// 这是一个修改操作，进行字符级细化
-				const auto& del_op = final_operations[i];
-				const auto& add_op = final_operations[i + 1];
-
-				const std::string& old_text = del_op.content;
-				const std::string& new_text = add_op.content;
-				size_t base_pos = del_op.start;
+				auto [iter, inserted] = histogram.try_emplace(a[i], i, 0);
+				if (!inserted)
+				{
+					next_same[i - a_lo] = iter->second.first;
+					iter->second.first = i;
+				}
+				++iter->second.second;
+			}
+			std::vector<size_t> counts(a_hi - a_lo);
+			for (size_t i = a_lo; i < a_hi; ++i)
+				counts[i - a_lo] = histogram[a[i]].second;
 
-				// 字符级比较
-				auto char_ops = _char_diff_in_region(old_text, new_text);
+			size_t best_a = 0, best_b = 0, best_length = 0;
+			size_t best_count = max_chain;  // 出现次数超过max_chain的元素不参与匹配
+			bool has_common = false;
 
-				// 调整位置到全局坐标
-				for (const auto& op : char_ops)
+			for (size_t j = b_lo; j < b_hi;)
+			{
+				size_t next_j = j + 1;
+				auto iter = histogram.find(b[j]);
+				if (iter != histogram.end())
 				{
-					optimized_operations.emplace_back(
-						op.type,
-						base_pos + op.start,
-						base_pos + op.end,
-						op.content
-					);
+					has_common = true;
+					if (iter->second.second <= best_count)
+					{
+						for (size_t i = iter->second.first; i != SIZE_MAX; i = next_same[i - a_lo])
+						{
+							// 向两侧扩展匹配区域，并取区域内最小出现次数
+							size_t start_a = i, start_b = j;
+							size_t rarity = counts[i - a_lo];
+							while (start_a > a_lo && start_b > b_lo && a[start_a - 1] == b[start_b - 1])
+							{
+								--start_a;
+								--start_b;
+								rarity = std::min(rarity, counts[start_a - a_lo]);
+							}
+							size_t end_a = i + 1, end_b = j + 1;
+							while (end_a < a_hi && end_b < b_hi && a[end_a] == b[end_b])
+							{
+								rarity = std::min(rarity, counts[end_a - a_lo]);
+								++end_a;
+								++end_b;
+							}
+
+							const size_t length = end_a - start_a;
+							if (rarity < best_count || (rarity == best_count && length > best_length))
+							{
+								best_a = start_a;
+								best_b = start_b;
+								best_length = length;
+								best_count = rarity;
+							}
+							next_j = std::max(next_j, end_b);
+						}
+					}
 				}
+				j = next_j;
+			}
 
-				i += 2;
+			if (best_length > 0)
+			{
+				_histogram_diff(a, a_lo, best_a, b, b_lo, best_b, max_chain, matches, work);
+				_push_diff_match(matches, best_a, best_b, best_length);
+				_histogram_diff(a, best_a + best_length, a_hi, b, best_b + best_length, b_hi, max_chain, matches, work);
 			}
-			else
+			else if (has_common)
 			{
-				optimized_operations.push_back(final_operations[i]);
-				++i;
+				// 公共元素全部为高频元素
+				_myers_diff(a, a_lo, a_hi, b, b_lo, b_hi, matches, work);
+			}
+		}
+
+		_push_diff_match(matches, a_hi, b_hi, suffix);
+	}
+
+	/**
+	 * @brief 完整LCS动态规划表求匹配段，回溯规则与_extract_line_operations相同
+	 */
+	template<typename T>
+	void _lcs_table_diff(
+		const T* a, size_t n,
+		const T* b, size_t m,
+		std::vector<_DiffMatch>& matches)
+	{
+		std::vector<std::vector<int>> lcs(n + 1, std::vector<int>(m + 1, 0));
+		for (size_t i = 1; i <= n; ++i)
+		{
+			for (size_t j = 1; j <= m; ++j)
+			{
+				if (a[i - 1] == b[j - 1])
+					lcs[i][j] = lcs[i - 1][j - 1] + 1;
+				else
+					lcs[i][j] = std::max(lcs[i - 1][j], lcs[i][j - 1]);
+			}
+		}
+
+		// 回溯得到逆序的匹配位置
+		std::vector<std::pair<size_t, size_t>> pairs;
+		size_t i = n, j = m;
+		while (i > 0 && j > 0)
+		{
+			if (a[i - 1] == b[j - 1])
+			{
+				pairs.emplace_back(i - 1, j - 1);
+				--i;
+				--j;
 			}
+			else if (lcs[i][j - 1] >= lcs[i - 1][j])
+				--j;
+			else
+				--i;
+		}
+		for (auto iter = pairs.rbegin(); iter != pairs.rend(); ++iter)
+			_push_diff_match(matches, iter->first, iter->second, 1);
+	}
+
+	/**
+	 * @brief 在两个整数编号序列上按选项运行差异算法
+	 * @return 按顺序排列的匹配段
+	 */
+	inline std::vector<_DiffMatch> _diff_token_ids(
+		const uint32_t* ids1, size_t count1,
+		const uint32_t* ids2, size_t count2,
+		const DiffOptions& options)
+	{
+		std::vector<_DiffMatch> matches;
+		std::vector<ptrdiff_t> work;
+		switch (options.algorithm)
+		{
+		case DiffAlgorithm::LCS:
+			_lcs_table_diff(ids1, count1, ids2, count2, matches);
+			break;
+		case DiffAlgorithm::Patience:
+			_patience_diff(ids1, 0, count1, ids2, 0, count2, matches, work);
+			break;
+		case DiffAlgorithm::Histogram:
+			_histogram_diff(ids1, 0, count1, ids2, 0, count2, options.histogram_max_chain, matches, work);
+			break;
+		default:
+			_myers_diff(ids1, 0, count1, ids2, 0, count2, matches, work);
+			break;
+		}
+		return matches;
+	}
+
+	/**
+	 * @brief 计算行级匹配段
+	 * Myers: 时间O((N+M)D)，空间O(N+M)，D为差异行数；
+	 * Patience/Histogram: 先以低频行为锚点切分，只在小缝隙中运行Myers
+	 * @param lines1 源字符串行数组
+	 * @param lines2 目标字符串行数组
+	 * @param options 差异算法选项
+	 * @return 按顺序排列的匹配段
+	 */
+	inline std::vector<_DiffMatch> _build_line_matches(
+		const std::vector<std::string>& lines1,
+		const std::vector<std::string>& lines2,
+		const DiffOptions& options = DiffOptions())
+	{
+		std::vector<uint32_t> ids1, ids2;
+		_intern_lines(lines1, lines2, ids1, ids2);
+		return _diff_token_ids(ids1.data(), ids1.size(), ids2.data(), ids2.size(), options);
+	}
+
+	/**
+	 * @brief 从匹配段提取行级操作序列
+	 * 与基于LCS表的版本输出格式一致: 同一差异块内删除在前、添加在后
+	 * @param lines1 源字符串行数组
+	 * @param lines2 目标字符串行数组
+	 * @param matches 按顺序排列的匹配段
+	 * @return 行级操作序列
+	 */
+	inline std::vector<LineOperation> _extract_line_operations(
+		const std::vector<std::string>& lines1,
+		const std::vector<std::string>& lines2,
+		const std::vector<_DiffMatch>& matches)
+	{
+		std::vector<LineOperation> operations;
+		size_t i = 0, j = 0;
+
+		auto flush = [&](size_t a, size_t b)
+			{
+				if (a > i)
+				{
+					operations.emplace_back(StringOpType::Delete, i, a,
+						std::vector<std::string>(lines1.begin() + i, lines1.begin() + a));
+				}
+				if (b > j)
+				{
+					operations.emplace_back(StringOpType::Add, a, a,
+						std::vector<std::string>(lines2.begin() + j, lines2.begin() + b));
+				}
+			};
+
+		for (const auto& match : matches)
+		{
+			flush(match.a, match.b);
+			i = match.a + match.length;
+			j = match.b + match.length;
 		}
+		flush(lines1.size(), lines2.size());
+
+		return operations;
+	}
+
+	/**
+	 * @brief 从匹配段提取字符级操作序列（连续的添加/删除已合并）
+	 * @param s1 源字符串
+	 * @param s2 目标字符串
+	 * @param matches 按顺序排列的字符匹配段
+	 * @return 操作序列（位置基于s1）
+	 */
+	inline std::vector<StringOperation> _extract_string_operations(
+		const std::string& s1,
+		const std::string& s2,
+		const std::vector<_DiffMatch>& matches)
+	{
+		std::vector<StringOperation> operations;
+		size_t i = 0, j = 0;
+
+		auto flush = [&](size_t a, size_t b)
+			{
+				if (a > i)
+					operations.emplace_back(StringOpType::Delete, i, a, s1.substr(i, a - i));
+				if (b > j)
+					operations.emplace_back(StringOpType::Add, a, a, s2.substr(j, b - j));
+			};
 
-		return optimized_operations;
+		for (const auto& match : matches)
+		{
+			flush(match.a, match.b);
+			i = match.a + match.length;
+			j = match.b + match.length;
+		}
+		flush(s1.length(), s2.length());
+
+		return operations;
+	}
+
+	/**
+	 * @brief 计算LCS表的最后一行（只保留两行）
+	 * @param reverse false: row[j] = LCS(a, b[0, j)); true: row[j] = LCS(a, b[m - j, m))
+	 * @param row 输出: 长度为m + 1的结果行
+	 */
+	inline void _lcs_last_row(
+		const char* a, size_t n,
+		const char* b, size_t m,
+		bool reverse,
+		std::vector<int>& row)
+	{
+		std::vector<int> prev(m + 1, 0);
+		row.assign(m + 1, 0);
+		for (size_t i = 0; i < n; ++i)
+		{
+			const char ch = reverse ? a[n - 1 - i] : a[i];
+			for (size_t j = 1; j <= m; ++j)
+			{
+				const char other = reverse ? b[m - j] : b[j - 1];
+				if (ch == other)
+					row[j] = prev[j - 1] + 1;
+				else
+					row[j] = std::max(prev[j], row[j - 1]);
+			}
+			prev.swap(row);
+		}
+		row.swap(prev);
+	}
+
+	/**
+	 * @brief Hirschberg分治求字符级LCS匹配段
+	 * 每层递归只保留两行，内存O(m + n)；分割点两侧相互独立，可交给不同线程
+	 * @param parallel_depth 剩余可并行展开的递归层数
+	 * @param matches 输出: 按顺序排列的匹配段
+	 */
+	inline void _hirschberg_matches(
+		const std::string& s1, size_t a_lo, size_t a_hi,
+		const std::string& s2, size_t b_lo, size_t b_hi,
+		int parallel_depth,
+		std::vector<_DiffMatch>& matches)
+	{
+		// 剥离公共前后缀
+		const size_t prefix = _common_prefix_length(
+			std::string_view(s1).substr(a_lo, a_hi - a_lo), std::string_view(s2).substr(b_lo, b_hi - b_lo));
+		_push_diff_match(matches, a_lo, b_lo, prefix);
+		a_lo += prefix;
+		b_lo += prefix;
+
+		const size_t suffix = _common_suffix_length(
+			std::string_view(s1).substr(a_lo, a_hi - a_lo), std::string_view(s2).substr(b_lo, b_hi - b_lo));
+		a_hi -= suffix;
+		b_hi -= suffix;
+
+		const size_t n = a_hi - a_lo;
+		const size_t m = b_hi - b_lo;
+		if (n == 1 && m > 0)
+		{
+			// 只在[b_lo, b_hi)中查找，不扫描s2的其余部分
+			const size_t pos = std::string_view(s2).substr(b_lo, m).find(s1[a_lo]);
+			if (pos != std::string_view::npos)
+				_push_diff_match(matches, a_lo, b_lo + pos, 1);
+		}
+		else if (n > 1 && m > 0)
+		{
+			// 寻找分割点: 上半部分正向、下半部分反向各算一行
+			const size_t mid = n / 2;
+			std::vector<int> upper, lower;
+			_lcs_last_row(s1.data() + a_lo, mid, s2.data() + b_lo, m, false, upper);
+			_lcs_last_row(s1.data() + a_lo + mid, n - mid, s2.data() + b_lo, m, true, lower);
+
+			size_t split = 0;
+			int best = -1;
+			for (size_t j = 0; j <= m; ++j)
+			{
+				int value = upper[j] + lower[m - j];
+				if (value > best)
+				{
+					best = value;
+					split = j;
+				}
+			}
+			std::vector<int>().swap(upper);
+			std::vector<int>().swap(lower);
+
+			// 规模足够大时左半部分交给其他线程
+			constexpr size_t parallel_threshold = size_t(1) << 20;
+			if (parallel_depth > 0 && n * m >= parallel_threshold)
+			{
+				auto left = std::async(std::launch::async, [&, a_lo, b_lo, mid, split]()
+					{
+						std::vector<_DiffMatch> result;
+						_hirschberg_matches(s1, a_lo, a_lo + mid, s2, b_lo, b_lo + split, parallel_depth - 1, result);
+						return result;
+					});
+				std::vector<_DiffMatch> right;
+				_hirschberg_matches(s1, a_lo + mid, a_hi, s2, b_lo + split, b_hi, parallel_depth - 1, right);
+				for (const auto& match : left.get())
+					_push_diff_match(matches, match.a, match.b, match.length);
+				for (const auto& match : right)
+					_push_diff_match(matches, match.a, match.b, match.length);
+			}
+			else
+			{
+				_hirschberg_matches(s1, a_lo, a_lo + mid, s2, b_lo, b_lo + split, 0, matches);
+				_hirschberg_matches(s1, a_lo + mid, a_hi, s2, b_lo + split, b_hi, 0, matches);
+			}
+		}
+
+		_push_diff_match(matches, a_hi, b_hi, suffix);
+	}
+
+	/**
+	 * @brief 计算两个字符串的编辑距离和操作序列（Hirschberg线性空间版本）
+	 * 编辑距离与GetEditorDistanceAndOperations相同，内存为O(m + n)而非O(mn)；
+	 * 存在多种最短编辑方式时，操作序列可能与之不同（但同样可以还原s2）
+	 * @param s1 源字符串
+	 * @param s2 目标字符串
+	 * @param thread_count 并行线程数（默认1，即单线程）
+	 * @return (编辑距离, 操作序列)
+	 */
+	inline std::pair<int, std::vector<StringOperation>> GetEditorDistanceAndOperationsLinearSpace(
+		const std::string& s1,
+		const std::string& s2,
+		size_t thread_count = 1)
+	{
+		int parallel_depth = 0;
+		while ((size_t(1) << parallel_depth) < thread_count)
+			++parallel_depth;
+
+		std::vector<_DiffMatch> matches;
+		_hirschberg_matches(s1, 0, s1.length(), s2, 0, s2.length(), parallel_depth, matches);
+
+		size_t lcs_length = 0;
+		for (const auto& match : matches)
+			lcs_length += match.length;
+
+		int edit_distance = static_cast<int>(s1.length() + s2.length() - 2 * lcs_length);
+		return { edit_distance, _extract_string_operations(s1, s2, matches) };
+	}
+
+	/**
+	 * @brief 64位整数中置位的数量
+	 */
+	inline int _popcount64(uint64_t value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_popcountll(value);
+#else
+		value = value - ((value >> 1) & 0x5555555555555555ULL);
+		value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+		value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		return static_cast<int>((value * 0x0101010101010101ULL) >> 56);
+#endif
+	}
+
+	/**
+	 * @brief 位并行模式串
+	 * 预先为模式串中每个字符建立位置掩码，每个机器字同时处理64个字符；
+	 * 模式串超过64个字符时按64位分块并在块间传递进位。
+	 * 对同一查询串反复计算距离时（如候选排序）应复用同一个实例
+	 */
+	class BitParallelPattern
+	{
+	private:
+		size_t length;
+		size_t words;
+		// 布局为masks[ch * words + word]，同一字符的各块掩码连续存放
+		std::vector<uint64_t> masks;
+
+		const uint64_t* GetMasks(char ch) const
+		{
+			return masks.data() + static_cast<size_t>(static_cast<unsigned char>(ch)) * words;
+		}
+
+	public:
+		explicit BitParallelPattern(std::string_view pattern)
+			: length(pattern.length()), words((pattern.length() + 63) / 64), masks(256 * words, 0)
+		{
+			for (size_t i = 0; i < length; ++i)
+			{
+				masks[static_cast<size_t>(static_cast<unsigned char>(pattern[i])) * words + i / 64] |= uint64_t(1) << (i % 64);
+			}
+		}
+
+		size_t Size() const noexcept
+		{
+			return length;
+		}
+
+		/**
+		 * @brief 模式串与text的最长公共子序列长度（Hyyrö位并行LCS）
+		 */
+		size_t GetLCSLength(std::string_view text) const
+		{
+			if (words == 0 || text.empty())
+				return 0;
+
+			std::vector<uint64_t> stripes(words, ~uint64_t(0));
+			for (char ch : text)
+			{
+				const uint64_t* current = GetMasks(ch);
+				uint64_t carry = 0;
+				for (size_t w = 0; w < words; ++w)
+				{
+					const uint64_t stripe = stripes[w];
+					const uint64_t u = stripe & current[w];
+					// 带进位加法
+					const uint64_t sum = stripe + carry;
+					const uint64_t x = sum + u;
+					carry = (sum < carry) || (x < u) ? 1 : 0;
+					stripes[w] = x | (stripe - u);
+				}
+			}
+
+			size_t result = 0;
+			for (size_t w = 0; w < words; ++w)
+			{
+				uint64_t value = ~stripes[w];
+				if (w + 1 == words && length % 64 != 0)
+					value &= (uint64_t(1) << (length % 64)) - 1;
+				result += _popcount64(value);
+			}
+			return result;
+		}
+
+		/**
+		 * @brief 与GetEditorDistanceAndOperations相同口径的编辑距离（仅插入/删除）
+		 */
+		int GetEditorDistance(std::string_view text) const
+		{
+			return static_cast<int>(length + text.length() - 2 * GetLCSLength(text));
+		}
+
+		/**
+		 * @brief Levenshtein距离（插入/删除/替换代价均为1，Myers/Hyyrö分块位向量算法）
+		 */
+		int GetLevenshteinDistance(std::string_view text) const
+		{
+			if (words == 0)
+				return static_cast<int>(text.length());
+
+			std::vector<uint64_t> vp(words, ~uint64_t(0));
+			std::vector<uint64_t> vn(words, 0);
+			const uint64_t last_bit = uint64_t(1) << ((length - 1) % 64);
+			int score = static_cast<int>(length);
+
+			for (char ch : text)
+			{
+				const uint64_t* current = GetMasks(ch);
+				// 首行D[0][j] = j，每列向下一块输入的水平差为+1
+				int carry_in = 1;
+				for (size_t w = 0; w < words; ++w)
+				{
+					uint64_t eq = current[w];
+					const uint64_t pv = vp[w];
+					const uint64_t mv = vn[w];
+					const uint64_t xv = eq | mv;
+					if (carry_in < 0)
+						eq |= 1;
+					const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+					uint64_t ph = mv | ~(xh | pv);
+					uint64_t mh = pv & xh;
+
+					const uint64_t high_bit = (w + 1 == words) ? last_bit : (uint64_t(1) << 63);
+					int carry_out = 0;
+					if (ph & high_bit)
+						carry_out = 1;
+					else if (mh & high_bit)
+						carry_out = -1;
+
+					ph <<= 1;
+					mh <<= 1;
+					if (carry_in < 0)
+						mh |= 1;
+					else if (carry_in > 0)
+						ph |= 1;
+
+					vp[w] = mh | ~(xv | ph);
+					vn[w] = ph & xv;
+					carry_in = carry_out;
+				}
+				score += carry_in;
+			}
+			return score;
+		}
+	};
+
+	/**
+	 * @brief 只计算编辑距离（不生成操作序列）
+	 * 与GetEditorDistanceAndOperations(s1, s2).first结果相同，使用位并行LCS，复杂度O(mn/64)
+	 * @param s1 源字符串
+	 * @param s2 目标字符串
+	 * @return 编辑距离
+	 */
+	inline int GetEditorDistance(std::string_view s1, std::string_view s2)
+	{
+		// 公共前后缀不影响距离
+		const size_t prefix = _common_prefix_length(s1, s2);
+		s1.remove_prefix(prefix);
+		s2.remove_prefix(prefix);
+		const size_t suffix = _common_suffix_length(s1, s2);
+		s1.remove_suffix(suffix);
+		s2.remove_suffix(suffix);
+
+		// 以较短的一方作为模式串以减少机器字数
+		if (s1.length() > s2.length())
+			std::swap(s1, s2);
+		if (s1.empty())
+			return static_cast<int>(s2.length());
+		return BitParallelPattern(s1).GetEditorDistance(s2);
+	}
+
+	/**
+	 * @brief 计算Levenshtein距离（替换计为1次操作），复杂度O(mn/64)
+	 * @param s1 源字符串
+	 * @param s2 目标字符串
+	 * @return Levenshtein距离
+	 */
+	inline int GetLevenshteinDistance(std::string_view s1, std::string_view s2)
+	{
+		const size_t prefix = _common_prefix_length(s1, s2);
+		s1.remove_prefix(prefix);
+		s2.remove_prefix(prefix);
+		const size_t suffix = _common_suffix_length(s1, s2);
+		s1.remove_suffix(suffix);
+		s2.remove_suffix(suffix);
+
+		if (s1.length() > s2.length())
+			std::swap(s1, s2);
+		if (s1.empty())
+			return static_cast<int>(s2.length());
+		return BitParallelPattern(s1).GetLevenshteinDistance(s2);
+	}
+
+	/**
+	 * @brief Ukkonen带状动态规划: 只计算|i - j| <= k的对角线带内的编辑距离（仅插入/删除）
+	 * 带外单元视为k + 1；一行内所有单元的距离加上剩余长度差的下界都超过k时立即结束
+	 * @param cells 工作区；keep_rows为true时保存全部行，第i行从i * (2k + 1)开始，单元(i, j)位于j - i + k
+	 * @return 编辑距离，超过k时为k + 1
+	 */
+	inline int _banded_edit_distance(std::string_view s1, std::string_view s2, int k, std::vector<int>& cells, bool keep_rows)
+	{
+		const size_t m = s1.length();
+		const size_t n = s2.length();
+		const size_t diff = m > n ? m - n : n - m;
+		if (diff > static_cast<size_t>(k))
+			return k + 1;
+
+		const size_t band = static_cast<size_t>(std::min<size_t>(static_cast<size_t>(k), std::max(m, n)));
+		const size_t width = 2 * band + 1;
+		const int over = k + 1;
+		cells.assign(keep_rows ? (m + 1) * width : 2 * width, over);
+		auto row_at = [&cells, width, keep_rows](size_t i) { return cells.data() + (keep_rows ? i : (i & 1)) * width; };
+
+		int* row = row_at(0);
+		for (size_t j = 0; j <= std::min(n, band); ++j)
+			row[j + band] = static_cast<int>(j);
+
+		for (size_t i = 1; i <= m; ++i)
+		{
+			const int* prev = row_at(i - 1);
+			row = row_at(i);
+			if (!keep_rows)
+				std::fill(row, row + width, over);
+
+			const size_t j_lo = i > band ? i - band : 0;
+			const size_t j_hi = std::min(n, i + band);
+			int best = over;
+			for (size_t j = j_lo; j <= j_hi; ++j)
+			{
+				const size_t index = j + band - i;
+				int value;
+				if (j == 0)
+					value = static_cast<int>(i);
+				else if (s1[i - 1] == s2[j - 1])
+					value = prev[index];
+				else
+				{
+					const int up = index + 1 < width ? prev[index + 1] : over;
+					const int left = j > j_lo ? row[index - 1] : over;
+					value = std::min(over, 1 + std::min(up, left));
+				}
+				row[index] = value;
+
+				// 剩余部分至少还需要|(m - i) - (n - j)|次操作
+				const size_t rest1 = m - i, rest2 = n - j;
+				const size_t remaining = rest1 > rest2 ? rest1 - rest2 : rest2 - rest1;
+				if (remaining <= static_cast<size_t>(k))
+					best = std::min(best, value + static_cast<int>(remaining));
+			}
+			if (best > k)
+				return over;
+		}
+		return row[n + band - m];
+	}
+
+	/**
+	 * @brief 判断编辑距离是否不超过k（仅插入/删除，与GetEditorDistance口径相同）
+	 * 只计算宽度为2k + 1的对角线带，复杂度O(k * n)；超过阈值后立即返回
+	 * @param s1 源字符串
+	 * @param s2 目标字符串
+	 * @param k 距离阈值（不能为负）
+	 * @return 编辑距离；超过k时返回k + 1
+	 */
+	inline int GetEditorDistanceBounded(std::string_view s1, std::string_view s2, int k)
+	{
+		if (k < 0)
+			throw std::invalid_argument("k must be non-negative");
+
+		const size_t prefix = _common_prefix_length(s1, s2);
+		s1.remove_prefix(prefix);
+		s2.remove_prefix(prefix);
+		const size_t suffix = _common_suffix_length(s1, s2);
+		s1.remove_suffix(suffix);
+		s2.remove_suffix(suffix);
+
+		if (s1.empty() || s2.empty())
+			return static_cast<int>(std::min<size_t>(s1.length() + s2.length(), static_cast<size_t>(k) + 1));
+		std::vector<int> cells;
+		return _banded_edit_distance(s1, s2, k, cells, false);
+	}
+
+	/**
+	 * @brief 计算编辑距离不超过k时的编辑距离和操作序列
+	 * 只计算宽度为2k + 1的对角线带，时间与内存为O(k * n)；
+	 * 距离不超过k时结果与GetEditorDistanceAndOperations完全相同
+	 * @param s1 源字符串
+	 * @param s2 目标字符串
+	 * @param k 距离阈值（不能为负）
+	 * @return (编辑距离, 操作序列)；距离超过k时返回std::nullopt
+	 */
+	inline std::optional<std::pair<int, std::vector<StringOperation>>> GetEditorDistanceAndOperationsBounded(
+		std::string_view s1,
+		std::string_view s2,
+		int k)
+	{
+		if (k < 0)
+			throw std::invalid_argument("k must be non-negative");
+
+		std::vector<int> cells;
+		const int distance = _banded_edit_distance(s1, s2, k, cells, true);
+		if (distance > k)
+			return std::nullopt;
+
+		// 回溯只比较i + j相同的两个单元，用i + j - d(i, j)（即LCS长度的2倍）代替LCS长度；
+		// 最优路径上的前驱一定在带内且距离精确，带外单元按k + 1处理不会改变比较结果
+		const size_t band = std::min<size_t>(static_cast<size_t>(k), std::max(s1.length(), s2.length()));
+		const size_t width = 2 * band + 1;
+		auto lcs_at = [&cells, band, width, k](size_t i, size_t j)
+			{
+				const bool inside = j + band >= i && j + band - i < width;
+				const int value = inside ? cells[i * width + (j + band - i)] : k + 1;
+				return static_cast<int>(i + j) - value;
+			};
+
+		std::vector<StringOperation> operations;
+		auto steps = _backtrack_lcs_path(s1, s2, lcs_at);
+		_replay_lcs_path(s1, s2, steps,
+			[&operations](StringOperationRef&& op) { operations.push_back(op.ToOperation()); });
+		return std::make_pair(distance, std::move(operations));
+	}
+
+	/**
+	 * @brief 按反对角线存储的字符级LCS表
+	 * 第d条反对角线保存所有i + j == d的单元，同一对角线上的单元连续存放，
+	 * 填表时每个单元只依赖前两条对角线，因此同一对角线可以整段向量化计算
+	 */
+	class _CharLCSTable
+	{
+	private:
+		std::vector<int> cells;
+		std::vector<size_t> offsets;  // 每条对角线在cells中的起点
+		std::string reversed2;        // s2的逆序，使对角线上的s2字符也按i递增连续
+
+	public:
+		const std::string_view s1;
+		const std::string_view s2;
+		const size_t m;
+		const size_t n;
+
+		_CharLCSTable(std::string_view s1, std::string_view s2)
+			: reversed2(s2.rbegin(), s2.rend()), s1(s1), s2(s2), m(s1.length()), n(s2.length())
+		{
+			offsets.resize(m + n + 2);
+			offsets[0] = 0;
+			for (size_t d = 0; d <= m + n; ++d)
+				offsets[d + 1] = offsets[d] + (DiagonalEnd(d) - DiagonalBegin(d) + 1);
+			cells.assign(offsets[m + n + 1], 0);
+		}
+
+		/**
+		 * @brief 第d条对角线上i的最小值
+		 */
+		size_t DiagonalBegin(size_t d) const noexcept
+		{
+			return d > n ? d - n : 0;
+		}
+		/**
+		 * @brief 第d条对角线上i的最大值
+		 */
+		size_t DiagonalEnd(size_t d) const noexcept
+		{
+			return std::min(m, d);
+		}
+		/**
+		 * @brief 第d条对角线上第i行单元的地址
+		 */
+		int* At(size_t d, size_t i) noexcept
+		{
+			return cells.data() + offsets[d] + (i - DiagonalBegin(d));
+		}
+		int Get(size_t i, size_t j) const noexcept
+		{
+			const size_t d = i + j;
+			return cells[offsets[d] + (i - DiagonalBegin(d))];
+		}
+		/**
+		 * @brief 对角线d上第i行对应的s2字符地址（逆序串中按i递增连续）
+		 */
+		const char* Reversed2At(size_t d, size_t i) const noexcept
+		{
+			return reversed2.data() + (n - d + i);
+		}
+	};
+
+	/**
+	 * @brief 标量内核: 计算对角线d上i属于[i_begin, i_end]的单元
+	 */
+	inline void _fill_char_lcs_diagonal_scalar(_CharLCSTable& table, size_t d, size_t i_begin, size_t i_end)
+	{
+		int* current = table.At(d, i_begin);
+		const int* up = table.At(d - 1, i_begin - 1);
+		const int* left = table.At(d - 1, i_begin);
+		const int* diag = table.At(d - 2, i_begin - 1);
+		const char* chars1 = table.s1.data() + i_begin - 1;
+		const char* chars2 = table.Reversed2At(d, i_begin);
+		const size_t count = i_end - i_begin + 1;
+		for (size_t k = 0; k < count; ++k)
+		{
+			if (chars1[k] == chars2[k])
+				current[k] = diag[k] + 1;
+			else
+				current[k] = std::max(up[k], left[k]);
+		}
+	}
+
+#ifdef CONVENTION_STRING_SIMD_X86
+	/**
+	 * @brief AVX2内核: 每次计算对角线上的8个单元
+	 * @return 尚未计算的第一个i
+	 */
+	CONVENTION_TARGET_AVX2 inline size_t _fill_char_lcs_diagonal_avx2(_CharLCSTable& table, size_t d, size_t i_begin, size_t i_end)
+	{
+		const __m256i one = _mm256_set1_epi32(1);
+		// 以i_begin为基准的各行指针，循环内只做偏移
+		int* current = table.At(d, i_begin);
+		const int* up = table.At(d - 1, i_begin - 1);
+		const int* left = table.At(d - 1, i_begin);
+		const int* diag = table.At(d - 2, i_begin - 1);
+		const char* chars1 = table.s1.data() + i_begin - 1;
+		const char* chars2 = table.Reversed2At(d, i_begin);
+		const size_t count = i_end - i_begin + 1;
+		size_t k = 0;
+		for (; k + 8 <= count; k += 8)
+		{
+			const __m256i v_up = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(up + k));
+			const __m256i v_left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + k));
+			const __m256i v_diag = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(diag + k));
+			const __m256i c1 = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(chars1 + k)));
+			const __m256i c2 = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(chars2 + k)));
+			const __m256i equal = _mm256_cmpeq_epi32(c1, c2);
+			const __m256i result = _mm256_blendv_epi8(_mm256_max_epi32(v_up, v_left), _mm256_add_epi32(v_diag, one), equal);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(current + k), result);
+		}
+		return i_begin + k;
+	}
+
+	/**
+	 * @brief SSE4.1内核: 每次计算对角线上的4个单元
+	 * @return 尚未计算的第一个i
+	 */
+	CONVENTION_TARGET_SSE41 inline size_t _fill_char_lcs_diagonal_sse41(_CharLCSTable& table, size_t d, size_t i_begin, size_t i_end)
+	{
+		const __m128i one = _mm_set1_epi32(1);
+		int* current = table.At(d, i_begin);
+		const int* up = table.At(d - 1, i_begin - 1);
+		const int* left = table.At(d - 1, i_begin);
+		const int* diag = table.At(d - 2, i_begin - 1);
+		const char* chars1 = table.s1.data() + i_begin - 1;
+		const char* chars2 = table.Reversed2At(d, i_begin);
+		const size_t count = i_end - i_begin + 1;
+		size_t k = 0;
+		for (; k + 4 <= count; k += 4)
+		{
+			const __m128i v_up = _mm_loadu_si128(reinterpret_cast<const __m128i*>(up + k));
+			const __m128i v_left = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + k));
+			const __m128i v_diag = _mm_loadu_si128(reinterpret_cast<const __m128i*>(diag + k));
+			int32_t bytes1 = 0, bytes2 = 0;
+			std::memcpy(&bytes1, chars1 + k, 4);
+			std::memcpy(&bytes2, chars2 + k, 4);
+			const __m128i c1 = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(bytes1));
+			const __m128i c2 = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(bytes2));
+			const __m128i equal = _mm_cmpeq_epi32(c1, c2);
+			const __m128i result = _mm_blendv_epi8(_mm_max_epi32(v_up, v_left), _mm_add_epi32(v_diag, one), equal);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(current + k), result);
+		}
+		return i_begin + k;
+	}
+#endif // CONVENTION_STRING_SIMD_X86
+
+	/**
+	 * @brief 字符级LCS表使用的内核
+	 */
+	enum class LCSKernel
+	{
+		Auto,    // 运行时选择可用的最快内核
+		Scalar,  // 标量实现
+		SSE41,   // 每步4个单元
+		AVX2     // 每步8个单元
+	};
+
+	/**
+	 * @brief 按反对角线顺序填充字符级LCS表
+	 * 各内核写入的数值完全一致，回溯得到的操作序列与标量版本逐字节相同
+	 * @param table 待填充的表（边界单元已为0）
+	 * @param kernel 指定内核，不支持的指令集会退回标量实现
+	 */
+	inline void _fill_char_lcs_table(_CharLCSTable& table, LCSKernel kernel = LCSKernel::Auto)
+	{
+#ifdef CONVENTION_STRING_SIMD_X86
+		if (kernel == LCSKernel::Auto)
+			kernel = SIMDIndicator::HasAVX2() ? LCSKernel::AVX2
+			: SIMDIndicator::HasSSE41() ? LCSKernel::SSE41 : LCSKernel::Scalar;
+		else if (kernel == LCSKernel::AVX2 && !SIMDIndicator::HasAVX2())
+			kernel = LCSKernel::Scalar;
+		else if (kernel == LCSKernel::SSE41 && !SIMDIndicator::HasSSE41())
+			kernel = LCSKernel::Scalar;
+#else
+		kernel = LCSKernel::Scalar;
+#endif
+
+		for (size_t d = 2; d <= table.m + table.n; ++d)
+		{
+			// 只计算i >= 1且j >= 1的内部单元
+			const size_t i_begin = std::max<size_t>(1, table.DiagonalBegin(d));
+			const size_t i_end = std::min(table.m, d - 1);
+			if (i_begin > i_end)
+				continue;
+
+			size_t i = i_begin;
+#ifdef CONVENTION_STRING_SIMD_X86
+			if (kernel == LCSKernel::AVX2)
+				i = _fill_char_lcs_diagonal_avx2(table, d, i_begin, i_end);
+			else if (kernel == LCSKernel::SSE41)
+				i = _fill_char_lcs_diagonal_sse41(table, d, i_begin, i_end);
+#endif
+			if (i <= i_end)
+				_fill_char_lcs_diagonal_scalar(table, d, i, i_end);
+		}
+	}
+
+	/**
+	 * @brief 从data开始的ASCII字节数（可用时按AVX2/SSE2整块检查最高位）
+	 */
+#ifdef CONVENTION_STRING_SIMD_X86
+	CONVENTION_TARGET_AVX2 inline size_t _ascii_prefix_avx2(const char* data, size_t n) noexcept
+	{
+		size_t i = 0;
+		for (; i + 32 <= n; i += 32)
+		{
+			const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i))));
+			if (mask != 0)
+				return i + _count_trailing_zeros32(mask);
+		}
+		return i;
+	}
+
+	CONVENTION_TARGET_SSE2 inline size_t _ascii_prefix_sse2(const char* data, size_t n) noexcept
+	{
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16)
+		{
+			const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))));
+			if (mask != 0)
+				return i + _count_trailing_zeros32(mask);
+		}
+		return i;
+	}
+#endif // CONVENTION_STRING_SIMD_X86
+
+	inline size_t _ascii_prefix_length(const char* data, size_t n) noexcept
+	{
+		size_t i = 0;
+#ifdef CONVENTION_STRING_SIMD_X86
+		if (SIMDIndicator::HasAVX2())
+			i = _ascii_prefix_avx2(data, n);
+		else if (SIMDIndicator::HasSSE2())
+			i = _ascii_prefix_sse2(data, n);
+#endif
+		while (i < n && static_cast<unsigned char>(data[i]) < 0x80)
+			++i;
+		return i;
+	}
+
+	/**
+	 * @brief 校验并解码从p开始的一个多字节UTF-8序列（RFC 3629: 拒绝超长编码、代理区与超过U+10FFFF的码点）
+	 * @param codepoint 输出: 解码得到的码点
+	 * @return 序列的字节数，不合法时为0
+	 */
+	inline size_t _decode_utf8_sequence(const unsigned char* p, size_t remaining, uint32_t& codepoint) noexcept
+	{
+		const unsigned char lead = p[0];
+		size_t length = 0;
+		unsigned char low = 0x80, high = 0xBF;  // 第二个字节的取值范围
+		if (lead >= 0xC2 && lead <= 0xDF)
+			length = 2;
+		else if (lead >= 0xE0 && lead <= 0xEF)
+		{
+			length = 3;
+			if (lead == 0xE0)
+				low = 0xA0;
+			else if (lead == 0xED)
+				high = 0x9F;
+		}
+		else if (lead >= 0xF0 && lead <= 0xF4)
+		{
+			length = 4;
+			if (lead == 0xF0)
+				low = 0x90;
+			else if (lead == 0xF4)
+				high = 0x8F;
+		}
+		else
+			return 0;
+
+		if (remaining < length || p[1] < low || p[1] > high)
+			return 0;
+		codepoint = lead & (0x7F >> length);
+		for (size_t i = 1; i < length; ++i)
+		{
+			if (i > 1 && (p[i] & 0xC0) != 0x80)
+				return 0;
+			codepoint = (codepoint << 6) | (p[i] & 0x3F);
+		}
+		return length;
+	}
+
+	/**
+	 * @brief 校验并解码UTF-8文本，ASCII连续段整块跳过
+	 * @param codepoints 输出: 码点数组
+	 * @param offsets 输出: 每个码点的起始字节偏移，末尾附加text.length()
+	 * @return text是否为合法的UTF-8
+	 */
+	inline bool _decode_utf8(std::string_view text, std::vector<uint32_t>& codepoints, std::vector<size_t>& offsets)
+	{
+		const auto* data = reinterpret_cast<const unsigned char*>(text.data());
+		const size_t n = text.length();
+		codepoints.clear();
+		offsets.clear();
+		codepoints.reserve(n);
+		offsets.reserve(n + 1);
+
+		size_t i = 0;
+		while (i < n)
+		{
+			const size_t ascii_end = i + _ascii_prefix_length(text.data() + i, n - i);
+			for (; i < ascii_end; ++i)
+			{
+				codepoints.push_back(data[i]);
+				offsets.push_back(i);
+			}
+			if (i == n)
+				break;
+
+			uint32_t codepoint = 0;
+			const size_t length = _decode_utf8_sequence(data + i, n - i, codepoint);
+			if (length == 0)
+				return false;
+			codepoints.push_back(codepoint);
+			offsets.push_back(i);
+			i += length;
+		}
+		offsets.push_back(n);
+		return true;
+	}
+
+	/**
+	 * @brief UTF-8续字节（10xxxxxx）
+	 */
+	inline bool _is_utf8_continuation(char c) noexcept
+	{
+		return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+	}
+
+	/**
+	 * @brief 把按单元（码点或词）计算的匹配段转换为字节位置的操作，匹配段之间的缝隙输出为删除与添加
+	 * @param offsets1 s1中每个单元的起始字节偏移，末尾为s1.length()
+	 * @param offsets2 s2中每个单元的起始字节偏移，末尾为s2.length()
+	 * @param base 加到操作位置上的偏移
+	 */
+	inline void _emit_unit_gaps(
+		std::string_view s1, const std::vector<size_t>& offsets1,
+		std::string_view s2, const std::vector<size_t>& offsets2,
+		const std::vector<_DiffMatch>& matches,
+		size_t base,
+		std::vector<StringOperationRef>& operations)
+	{
+		size_t i = 0, j = 0;
+		auto emit_gap = [&](size_t a, size_t b)
+			{
+				if (a > i)
+					operations.emplace_back(StringOpType::Delete, base + offsets1[i], base + offsets1[a],
+						s1.substr(offsets1[i], offsets1[a] - offsets1[i]));
+				if (b > j)
+					operations.emplace_back(StringOpType::Add, base + offsets1[a], base + offsets1[a],
+						s2.substr(offsets2[j], offsets2[b] - offsets2[j]));
+			};
+		for (const auto& match : matches)
+		{
+			emit_gap(match.a, match.b);
+			i = match.a + match.length;
+			j = match.b + match.length;
+		}
+		emit_gap(offsets1.size() - 1, offsets2.size() - 1);
+	}
+
+	/**
+	 * @brief 按码点比较两段合法的UTF-8文本，操作位置仍为字节偏移
+	 * @param base 加到操作位置上的偏移
+	 * @return 是否完成（任一侧不是合法UTF-8时返回false且不输出操作）
+	 */
+	inline bool _codepoint_diff_in_region_refs(
+		std::string_view s1,
+		std::string_view s2,
+		size_t base,
+		std::vector<StringOperationRef>& operations)
+	{
+		std::vector<uint32_t> codepoints1, codepoints2;
+		std::vector<size_t> offsets1, offsets2;
+		if (!_decode_utf8(s1, codepoints1, offsets1) || !_decode_utf8(s2, codepoints2, offsets2))
+			return false;
+
+		// 码点作为编号交给Myers
+		auto matches = _diff_token_ids(codepoints1.data(), codepoints1.size(), codepoints2.data(), codepoints2.size(), DiffOptions());
+		_emit_unit_gaps(s1, offsets1, s2, offsets2, matches, base, operations);
+		return true;
+	}
+
+	/**
+	 * @brief 按options.tokenizer把text切分为词
+	 * @param offsets 输出: 每个词的起始字节偏移，末尾附加text.length()
+	 */
+	inline void _tokenize(std::string_view text, const DiffOptions& options, std::vector<size_t>& offsets)
+	{
+		auto is_space = [](unsigned char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f'; };
+		auto is_word = [](unsigned char c) { return c >= 0x80 || c == '_' || (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z'); };
+
+		offsets.clear();
+		size_t pos = 0;
+		while (pos < text.length())
+		{
+			offsets.push_back(pos);
+			const unsigned char c = static_cast<unsigned char>(text[pos]);
+			size_t end = pos + 1;
+			switch (options.tokenizer)
+			{
+			case DiffTokenizer::Whitespace:
+				while (end < text.length() && is_space(static_cast<unsigned char>(text[end])) == is_space(c))
+					++end;
+				break;
+			case DiffTokenizer::Identifier:
+				if (is_space(c))
+				{
+					while (end < text.length() && is_space(static_cast<unsigned char>(text[end])))
+						++end;
+				}
+				else if (is_word(c))
+				{
+					while (end < text.length() && is_word(static_cast<unsigned char>(text[end])))
+						++end;
+				}
+				break;
+			case DiffTokenizer::Custom:
+				if (!options.custom_tokenizer)
+					throw std::invalid_argument("custom_tokenizer is empty");
+				// 返回0时按1处理以保证推进，超出文本时截断
+				end = pos + std::min(std::max<size_t>(1, options.custom_tokenizer(text, pos)), text.length() - pos);
+				break;
+			default:
+				break;
+			}
+			pos = end;
+		}
+		offsets.push_back(text.length());
+	}
+
+	/**
+	 * @brief 以词为单位比较两段文本，匹配的词之间整词删除/添加
+	 * @param base 加到操作位置上的偏移
+	 */
+	inline std::vector<StringOperationRef> _token_diff_in_region_refs(
+		std::string_view s1,
+		std::string_view s2,
+		const DiffOptions& options,
+		size_t base = 0)
+	{
+		// 与字符级细化相同的规模上限，超过时整块删除/添加
+		if (!s2.empty() && s1.length() > options.char_table_max_cells / s2.length())
+			return { StringOperationRef(StringOpType::Delete, base, base + s1.length(), s1),
+				StringOperationRef(StringOpType::Add, base + s1.length(), base + s1.length(), s2) };
+
+		std::vector<size_t> offsets1, offsets2;
+		_tokenize(s1, options, offsets1);
+		_tokenize(s2, options, offsets2);
+
+		// 词映射为整数编号后交给Myers
+		std::unordered_map<std::string_view, uint32_t> table;
+		table.reserve(offsets1.size() + offsets2.size());
+		auto intern = [&table](std::string_view text, const std::vector<size_t>& offsets)
+			{
+				std::vector<uint32_t> ids;
+				ids.reserve(offsets.size() - 1);
+				for (size_t i = 0; i + 1 < offsets.size(); ++i)
+				{
+					auto [iter, inserted] = table.try_emplace(text.substr(offsets[i], offsets[i + 1] - offsets[i]), static_cast<uint32_t>(table.size()));
+					ids.push_back(iter->second);
+				}
+				return ids;
+			};
+		const std::vector<uint32_t> ids1 = intern(s1, offsets1);
+		const std::vector<uint32_t> ids2 = intern(s2, offsets2);
+		auto matches = _diff_token_ids(ids1.data(), ids1.size(), ids2.data(), ids2.size(), DiffOptions());
+
+		std::vector<StringOperationRef> operations;
+		_emit_unit_gaps(s1, offsets1, s2, offsets2, matches, base, operations);
+		return operations;
+	}
+
+	/**
+	 * @brief 对小范围区域进行字符级LCS比较，结果引用输入字符串而不复制
+	 * 使用结果期间s1与s2必须保持有效
+	 * @param s1 源字符串
+	 * @param s2 目标字符串
+	 * @param utf8 按UTF-8码点比较；任一侧不是合法UTF-8时退回按字节比较
+	 * @param max_table_cells 细化的最大规模（删除字节数×添加字节数），超过时不细化，整块删除/添加
+	 * @return 操作序列（相对于输入字符串的位置）
+	 */
+	inline std::vector<StringOperationRef> _char_diff_in_region_refs(
+		std::string_view s1,
+		std::string_view s2,
+		bool utf8 = false,
+		size_t max_table_cells = DiffOptions::default_char_table_max_cells)
+	{
+		// 公共前后缀不参与填表，操作位置最后再平移回原串
+		size_t prefix = _common_prefix_length(s1, s2);
+		size_t suffix = _common_suffix_length(s1.substr(prefix), s2.substr(prefix));
+		if (utf8)
+		{
+			// 边界退回到码点起点，不拆分多字节字符
+			while (prefix > 0 && ((prefix < s1.length() && _is_utf8_continuation(s1[prefix]))
+				|| (prefix < s2.length() && _is_utf8_continuation(s2[prefix]))))
+				--prefix;
+			suffix = _common_suffix_length(s1.substr(prefix), s2.substr(prefix));
+			while (suffix > 0 && _is_utf8_continuation(s1[s1.length() - suffix]))
+				--suffix;
+		}
+		s1.remove_prefix(prefix);
+		s2.remove_prefix(prefix);
+		s1.remove_suffix(suffix);
+		s2.remove_suffix(suffix);
+
+		const size_t m = s1.length();
+		const size_t n = s2.length();
+
+		// 快速路径
+		if (m == 0 && n == 0)
+			return {};
+		if (m == 0)
+			return { StringOperationRef(StringOpType::Add, prefix, prefix, s2) };
+		if (n == 0)
+			return { StringOperationRef(StringOpType::Delete, prefix, prefix + m, s1) };
+
+		// 差异块过大: 任何细化的时间都接近O(m * n)，直接整块删除/添加
+		if (m > max_table_cells / n)
+			return { StringOperationRef(StringOpType::Delete, prefix, prefix + m, s1),
+				StringOperationRef(StringOpType::Add, prefix + m, prefix + m, s2) };
+
+		std::vector<StringOperationRef> operations;
+		if (utf8 && _codepoint_diff_in_region_refs(s1, s2, prefix, operations))
+			return operations;
+
+		// 字符级LCS（按反对角线填表，可用时走SIMD内核）
+		_CharLCSTable lcs(s1, s2);
+		_fill_char_lcs_table(lcs);
+
+		// 回溯路径后正序生成操作
+		auto steps = _backtrack_lcs_path(s1, s2, [&lcs](size_t i, size_t j) { return lcs.Get(i, j); });
+		_replay_lcs_path(s1, s2, steps,
+			[&operations, prefix](StringOperationRef&& op)
+			{
+				op.start += prefix;
+				op.end += prefix;
+				operations.push_back(op);
+			});
+		return operations;
+	}
+
+	/**
+	 * @brief 对小范围区域进行字符级LCS比较
+	 * @param s1 源字符串
+	 * @param s2 目标字符串
+	 * @return 操作序列（相对于输入字符串的位置）
+	 */
+	inline std::vector<StringOperation> _char_diff_in_region(
+		const std::string& s1,
+		const std::string& s2)
+	{
+		return MaterializeOperations(_char_diff_in_region_refs(s1, s2));
+	}
+
+	/**
+	 * @brief 分割字符串为行数组
+	 * @param s 输入字符串
+	 * @return 行数组
+	 */
+	inline std::vector<std::string> _split_lines(const std::string& s)
+	{
+		std::vector<std::string> lines;
+		size_t start = 0;
+		size_t pos = 0;
+
+		while ((pos = s.find('\n', start)) != std::string::npos)
+		{
+			lines.push_back(s.substr(start, pos - start));
+			start = pos + 1;
+		}
+
+		// 添加最后一行（即使为空）
+		lines.push_back(s.substr(start));
+
+		return lines;
+	}
+
+	/**
+	 * @brief 分割字符串为行视图数组，分行规则与_split_lines相同
+	 * @param s 输入字符串（使用期间必须保持有效）
+	 * @return 引用s的行数组
+	 */
+	inline std::vector<std::string_view> _split_lines_view(std::string_view s)
+	{
+		std::vector<std::string_view> lines;
+		size_t start = 0;
+		size_t pos = 0;
+
+		while ((pos = s.find('\n', start)) != std::string_view::npos)
+		{
+			lines.push_back(s.substr(start, pos - start));
+			start = pos + 1;
+		}
+
+		// 添加最后一行（即使为空）
+		lines.push_back(s.substr(start));
+
+		return lines;
+	}
+
+	/**
+	 * @brief 连接字符串数组为单个字符串
+	 * @param lines 字符串数组
+	 * @param separator 分隔符（默认换行符）
+	 * @return 连接后的字符串
+	 */
+	template<typename Line>
+	std::string _join_lines_impl(const std::vector<Line>& lines, std::string_view separator)
+	{
+		if (lines.empty())
+			return "";
+
+		size_t total = separator.length() * (lines.size() - 1);
+		for (const auto& line : lines)
+			total += line.length();
+
+		std::string result;
+		result.reserve(total);
+		result.append(lines[0]);
+		for (size_t i = 1; i < lines.size(); ++i)
+		{
+			result.append(separator);
+			result.append(lines[i]);
+		}
+		return result;
+	}
+
+	inline std::string _join_lines(const std::vector<std::string>& lines, const std::string& separator = "\n")
+	{
+		return _join_lines_impl(lines, separator);
+	}
+
+	inline std::string _join_lines(const std::vector<std::string_view>& lines, std::string_view separator = "\n")
+	{
+		return _join_lines_impl(lines, separator);
+	}
+
+	/**
+	 * @brief 行在源文本中的位置（字节偏移与长度，不含换行符）
+	 */
+	struct _LineSpan
+	{
+		size_t offset;
+		size_t length;
+
+		size_t End() const noexcept
+		{
+			return offset + length;
+		}
+	};
+
+	/**
+	 * @brief 读取从pos开始的一行
+	 * @param done 输出: 该行是否为文本的最后一行
+	 * @return 该行的位置；下一行从End() + 1开始
+	 */
+	inline _LineSpan _read_line_span(std::string_view text, size_t pos, bool& done)
+	{
+		const void* found = pos < text.length() ? std::memchr(text.data() + pos, '\n', text.length() - pos) : nullptr;
+		if (found == nullptr)
+		{
+			done = true;
+			return { pos, text.length() - pos };
+		}
+		done = false;
+		return { pos, static_cast<size_t>(static_cast<const char*>(found) - text.data()) - pos };
+	}
+
+	/**
+	 * @brief 按'\n'分割为行位置数组，与_split_lines的分行规则一致但不复制内容
+	 */
+	inline std::vector<_LineSpan> _split_line_spans(std::string_view text)
+	{
+		std::vector<_LineSpan> spans;
+		size_t pos = 0;
+		bool done = false;
+		while (!done)
+		{
+			spans.push_back(_read_line_span(text, pos, done));
+			pos = spans.back().End() + 1;
+		}
+		return spans;
+	}
+
+	/**
+	 * @brief 只分割text中[prefix, text.length() - suffix)部分的行，偏移仍相对于整个text
+	 * prefix必须位于行首；suffix不为0时其起点也必须位于行首，此时不包含其后的空行
+	 */
+	inline std::vector<_LineSpan> _split_line_spans(std::string_view text, size_t prefix, size_t suffix)
+	{
+		const std::string_view head = text.substr(0, text.length() - suffix);
+		std::vector<_LineSpan> spans;
+		size_t pos = prefix;
+		bool done = false;
+		while (!done)
+		{
+			spans.push_back(_read_line_span(head, pos, done));
+			pos = spans.back().End() + 1;
+		}
+		if (suffix > 0)
+			spans.pop_back();
+		return spans;
+	}
+
+	/**
+	 * @brief 按整行计算两段文本的公共前后缀
+	 * 先整块比较字节，再把前缀退回到最后一个换行符之后、把后缀推进到第一个换行符之后，
+	 * 因此两侧剩余的中间部分都由完整的行组成
+	 * @param prefix 输出: 公共前缀的字节数（0或紧跟在换行符之后）
+	 * @param suffix 输出: 公共后缀的字节数（0或紧跟在换行符之后），不与前缀重叠
+	 */
+	inline void _trim_common_lines(std::string_view s1, std::string_view s2, size_t& prefix, size_t& suffix)
+	{
+		prefix = _common_prefix_length(s1, s2);
+		const size_t last_newline = prefix == 0 ? std::string_view::npos : s1.rfind('\n', prefix - 1);
+		prefix = last_newline == std::string_view::npos ? 0 : last_newline + 1;
+
+		const size_t common = _common_suffix_length(s1.substr(prefix), s2.substr(prefix));
+		const size_t first_newline = s1.find('\n', s1.length() - common);
+		suffix = first_newline == std::string_view::npos ? 0 : s1.length() - first_newline - 1;
+	}
+
+	/**
+	 * @brief 将两组行位置映射为整数编号，内容相同的行编号相同
+	 */
+	inline void _intern_line_spans(
+		std::string_view text1, const _LineSpan* spans1, size_t count1,
+		std::string_view text2, const _LineSpan* spans2, size_t count2,
+		std::vector<uint32_t>& ids1,
+		std::vector<uint32_t>& ids2)
+	{
+		std::unordered_map<std::string_view, uint32_t> table;
+		table.reserve(count1 + count2);
+		auto intern = [&table](std::string_view text, const _LineSpan* spans, size_t count, std::vector<uint32_t>& ids)
+			{
+				ids.clear();
+				ids.reserve(count);
+				for (size_t i = 0; i < count; ++i)
+				{
+					auto [iter, inserted] = table.try_emplace(text.substr(spans[i].offset, spans[i].length), static_cast<uint32_t>(table.size()));
+					ids.push_back(iter->second);
+				}
+			};
+		intern(text1, spans1, count1, ids1);
+		intern(text2, spans2, count2, ids2);
+	}
+
+	/**
+	 * @brief 一组连续的行位置及其所在文本
+	 * 用于把行号换算为字符偏移；窗口化处理时只包含文本的一部分行
+	 */
+	struct _LineSpanRange
+	{
+		std::string_view text;
+		const _LineSpan* spans;
+		size_t count;
+		bool reaches_end;  // 最后一项是否为文本的最后一行
+		size_t end;        // 最后一项之后一行的起点，已到文本末尾时为文本长度
+
+		_LineSpanRange(std::string_view text, const _LineSpan* spans, size_t count, bool reaches_end)
+			: text(text), spans(spans), count(count), reaches_end(reaches_end),
+			end(reaches_end || count == 0 ? text.length() : spans[count - 1].End() + 1) {
+		}
+		_LineSpanRange(std::string_view text, const _LineSpan* spans, size_t count, bool reaches_end, size_t end)
+			: text(text), spans(spans), count(count), reaches_end(reaches_end), end(end) {
+		}
+
+		/**
+		 * @brief 第index行的起始偏移；index == count时为end
+		 */
+		size_t LineStart(size_t index) const noexcept
+		{
+			return index < count ? spans[index].offset : end;
+		}
+	};
+
+	/**
+	 * @brief 将一个差异块（源行[a0, a1)替换为目标行[b0, b1)）转换为字符级操作
+	 * 同时包含删除与添加时进行字符级细化，否则输出整块的删除/添加。
+	 * 整行的删除/添加包含行间的换行符，content恰好是所在文本中[start, end)或插入的连续区域，
+	 * 因此按顺序应用操作即可还原目标文本
+	 */
+	template<typename Callback>
+	void _emit_line_hunk(
+		const _LineSpanRange& range1,
+		const _LineSpanRange& range2,
+		size_t a0, size_t a1,
+		size_t b0, size_t b1,
+		const DiffOptions& options,
+		Callback&& callback)
+	{
+		const size_t insert_pos = range1.LineStart(a1);
+		const bool at_end = a1 == range1.count && range1.reaches_end;
+		if (a1 > a0 && b1 > b0)
+		{
+			const size_t base_pos = range1.spans[a0].offset;
+			const size_t add_begin = range2.spans[b0].offset;
+			const std::string_view old_text = range1.text.substr(base_pos, range1.spans[a1 - 1].End() - base_pos);
+			const std::string_view new_text = range2.text.substr(add_begin, range2.spans[b1 - 1].End() - add_begin);
+			// 指定分词方式时以词为单位，否则进行字符级细化
+			const std::vector<StringOperationRef> operations = options.tokenizer == DiffTokenizer::None
+				? _char_diff_in_region_refs(old_text, new_text, options.utf8, options.char_table_max_cells)
+				: _token_diff_in_region_refs(old_text, new_text, options);
+			for (const auto& op : operations)
+				callback(StringOperationRef(op.type, base_pos + op.start, base_pos + op.end, op.content));
+		}
+		else if (a1 > a0)
+		{
+			// 删除到文本末尾时改为删除前一行末尾的换行符
+			size_t begin = range1.spans[a0].offset;
+			if (at_end && begin > 0)
+				--begin;
+			callback(StringOperationRef(StringOpType::Delete, begin, insert_pos,
+				range1.text.substr(begin, insert_pos - begin)));
+		}
+		else if (b1 > b0)
+		{
+			// 在行前插入时每行都带换行符；追加到文本末尾时换行符在各行之前
+			size_t begin = range2.spans[b0].offset;
+			size_t end = range2.spans[b1 - 1].End();
+			if (!at_end)
+				++end;
+			else if (begin > 0)
+				--begin;
+			callback(StringOperationRef(StringOpType::Add, insert_pos, insert_pos,
+				range2.text.substr(begin, end - begin)));
+		}
+	}
+
+	/**
+	 * @brief 输出匹配段之间的全部差异块，最后一段匹配之后的缝隙截止到(end_a, end_b)
+	 */
+	template<typename Callback>
+	void _emit_line_matches(
+		const _LineSpanRange& range1,
+		const _LineSpanRange& range2,
+		const std::vector<_DiffMatch>& matches,
+		size_t end_a, size_t end_b,
+		const DiffOptions& options,
+		Callback&& callback)
+	{
+		size_t i = 0, j = 0;
+		for (const auto& match : matches)
+		{
+			_emit_line_hunk(range1, range2, i, match.a, j, match.b, options, callback);
+			i = match.a + match.length;
+			j = match.b + match.length;
+		}
+		_emit_line_hunk(range1, range2, i, end_a, j, end_b, options, callback);
+	}
+
+	/**
+	 * @brief 以最多thread_count个线程执行task(0) ... task(task_count - 1)
+	 * 各线程通过原子计数领取任务，当前线程也参与执行；任务抛出的异常在全部线程结束后重新抛出
+	 */
+	template<typename Task>
+	void _run_parallel(size_t task_count, size_t thread_count, const Task& task)
+	{
+		std::atomic<size_t> next_task{ 0 };
+		auto worker = [&]()
+			{
+				for (size_t index = next_task++; index < task_count; index = next_task++)
+					task(index);
+			};
+
+		std::vector<std::future<void>> workers;
+		for (size_t i = 1; i < std::min(thread_count, task_count); ++i)
+			workers.push_back(std::async(std::launch::async, worker));
+		std::exception_ptr error;
+		try
+		{
+			worker();
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+			next_task = task_count;
+		}
+		for (auto& future : workers)
+		{
+			try
+			{
+				future.get();
+			}
+			catch (...)
+			{
+				if (!error)
+					error = std::current_exception();
+			}
+		}
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+	/**
+	 * @brief 并行锚点差异: 以两侧唯一的公共行为切点把输入分成互不相关的分段，
+	 * 各分段在线程池中独立计算行级匹配并转换为字符级操作，最后按顺序拼接
+	 * 切点行固定为匹配，因此结果可能与单线程结果不同，但仍是正确的差异
+	 * @param callback 全部分段完成后按分段顺序接收操作
+	 * @return 是否已处理；没有可用切点时返回false且不调用callback
+	 */
+	template<typename Callback>
+	bool _parallel_anchored_diff(
+		const _LineSpanRange& range1,
+		const _LineSpanRange& range2,
+		const uint32_t* ids1,
+		const uint32_t* ids2,
+		const DiffOptions& options,
+		size_t thread_count,
+		Callback&& callback)
+	{
+		constexpr size_t min_segment_lines = 1024;
+		const size_t count1 = range1.count;
+		const size_t count2 = range2.count;
+		const size_t target = std::max(min_segment_lines, (count1 + count2) / (thread_count * 4));
+		if (count1 + count2 < 2 * target)
+			return false;
+
+		// 分段以切点行结尾（含切点），最后一段延伸到文本末尾
+		struct Segment
+		{
+			size_t a_lo, a_hi;
+			size_t b_lo, b_hi;
+		};
+		std::vector<Segment> segments;
+		size_t prev_a = 0, prev_b = 0;
+		for (const auto& [pos_a, pos_b] : _unique_common_anchors(ids1, 0, count1, ids2, 0, count2))
+		{
+			if (pos_a + 1 - prev_a + pos_b + 1 - prev_b < target)
+				continue;
+			segments.push_back({ prev_a, pos_a + 1, prev_b, pos_b + 1 });
+			prev_a = pos_a + 1;
+			prev_b = pos_b + 1;
+		}
+		if (segments.empty())
+			return false;
+		segments.push_back({ prev_a, count1, prev_b, count2 });
+
+		std::vector<std::vector<StringOperationRef>> results(segments.size());
+		_run_parallel(segments.size(), thread_count, [&](size_t index)
+			{
+				const Segment& segment = segments[index];
+				const size_t length_a = segment.a_hi - segment.a_lo;
+				const size_t length_b = segment.b_hi - segment.b_lo;
+				const bool last = index + 1 == segments.size();
+				// 最后一段沿用整体范围的末尾
+				const _LineSpanRange sub1 = last
+					? _LineSpanRange(range1.text, range1.spans + segment.a_lo, length_a, range1.reaches_end, range1.end)
+					: _LineSpanRange(range1.text, range1.spans + segment.a_lo, length_a, false);
+				const _LineSpanRange sub2 = last
+					? _LineSpanRange(range2.text, range2.spans + segment.b_lo, length_b, range2.reaches_end, range2.end)
+					: _LineSpanRange(range2.text, range2.spans + segment.b_lo, length_b, false);
+				auto matches = _diff_token_ids(ids1 + segment.a_lo, length_a, ids2 + segment.b_lo, length_b, options);
+				auto& output = results[index];
+				_emit_line_matches(sub1, sub2, matches, length_a, length_b, options,
+					[&output](StringOperationRef&& op) { output.push_back(op); });
+			});
+
+		for (auto& result : results)
+		{
+			for (auto& op : result)
+				callback(std::move(op));
+			std::vector<StringOperationRef>().swap(result);
+		}
+		return true;
+	}
+
+	/**
+	 * @brief 在已分行并编号的两段文本上计算差异操作序列
+	 * @param range1 源文本中参与比较的行（已剥离的公共前后缀之外）
+	 * @param range2 目标文本中参与比较的行
+	 * @param ids1 range1各行的编号
+	 * @param ids2 range2各行的编号
+	 * @param options 差异算法选项
+	 * @param callback 接收操作的回调: 单线程时每个差异块细化完成后立即调用，
+	 * 并行锚点模式下在全部分段完成后按顺序调用
+	 */
+	template<typename Callback>
+	void _diff_line_ranges(
+		const _LineSpanRange& range1,
+		const _LineSpanRange& range2,
+		const uint32_t* ids1,
+		const uint32_t* ids2,
+		const DiffOptions& options,
+		Callback&& callback)
+	{
+		// 多线程时按唯一公共行切分后并行处理
+		const size_t thread_count = options.thread_count == 0
+			? std::max<size_t>(1, std::thread::hardware_concurrency())
+			: options.thread_count;
+		if (thread_count > 1 && _parallel_anchored_diff(range1, range2, ids1, ids2, options, thread_count, callback))
+			return;
+
+		// 行级差异分析（默认Myers算法，耗时与内存正比于差异规模）
+		auto matches = _diff_token_ids(ids1, range1.count, ids2, range2.count, options);
+
+		// 每个差异块转换为字符级操作，删除+添加的块进行字符级细化
+		_emit_line_matches(range1, range2, matches, range1.count, range2.count, options, callback);
+	}
+
+	inline std::vector<StringOperationRef> _diff_line_ranges(
+		const _LineSpanRange& range1,
+		const _LineSpanRange& range2,
+		const uint32_t* ids1,
+		const uint32_t* ids2,
+		const DiffOptions& options)
+	{
+		std::vector<StringOperationRef> operations;
+		_diff_line_ranges(range1, range2, ids1, ids2, options,
+			[&operations](StringOperationRef&& op) { operations.push_back(op); });
+		return operations;
+	}
+
+	/**
+	 * @brief GetDiffOperationViews的回调形式: 剥离公共行、分行编号后逐块输出引用s1/s2的操作
+	 * @param s1 源字符串
+	 * @param s2 目标字符串
+	 * @param options 差异算法选项
+	 * @param callback 按位置顺序接收操作的回调
+	 */
+	template<typename Callback>
+	void _diff_operation_views(
+		std::string_view s1,
+		std::string_view s2,
+		const DiffOptions& options,
+		Callback&& callback)
+	{
+		// 快速路径
+		if (s1 == s2)
+			return;
+		if (s1.empty())
+			return callback(StringOperationRef(StringOpType::Add, 0, 0, s2));
+		if (s2.empty())
+			return callback(StringOperationRef(StringOpType::Delete, 0, s1.length(), s1));
+
+		// 阶段1: 整块剥离公共的首尾行（LCS算法保持旧版对齐方式，不剥离）
+		size_t prefix = 0, suffix = 0;
+		if (options.algorithm != DiffAlgorithm::LCS)
+			_trim_common_lines(s1, s2, prefix, suffix);
+
+		// 阶段2: 只对中间部分分行，记录每行的偏移与长度
+		std::vector<_LineSpan> spans1 = _split_line_spans(s1, prefix, suffix);
+		std::vector<_LineSpan> spans2 = _split_line_spans(s2, prefix, suffix);
+
+		// 阶段3: 行映射为整数编号
+		std::vector<uint32_t> ids1, ids2;
+		_intern_line_spans(s1, spans1.data(), spans1.size(), s2, spans2.data(), spans2.size(), ids1, ids2);
+		_LineSpanRange range1(s1, spans1.data(), spans1.size(), suffix == 0, s1.length() - suffix);
+		_LineSpanRange range2(s2, spans2.data(), spans2.size(), suffix == 0, s2.length() - suffix);
+
+		_diff_line_ranges(range1, range2, ids1.data(), ids2.data(), options, callback);
+	}
+
+	/**
+	 * @brief 计算两个字符串的差异操作序列，操作内容引用s1/s2而不复制
+	 * 操作序列与GetDiffOperations相同；使用结果期间s1与s2必须保持有效
+	 * @param s1 源字符串
+	 * @param s2 目标字符串
+	 * @param options 差异算法选项（默认Myers）
+	 * @return 差异操作序列
+	 */
+	inline std::vector<StringOperationRef> GetDiffOperationViews(
+		std::string_view s1,
+		std::string_view s2,
+		const DiffOptions& options = DiffOptions())
+	{
+		std::vector<StringOperationRef> operations;
+		_diff_operation_views(s1, s2, options,
+			[&operations](StringOperationRef&& op) { operations.push_back(op); });
+		return operations;
+	}
+
+	/**
+	 * @brief 计算两个字符串的差异操作序列（混合行级+字符级算法）
+	 * 操作格式: (操作类型, 开始位置, 结束位置, 内容)
+	 * 位置基于源字符串s1的字符偏移
+	 * @param s1 源字符串
+	 * @param s2 目标字符串
+	 * @param options 差异算法选项（默认Myers）
+	 * @return 差异操作序列
+	 */
+	inline std::vector<StringOperation> GetDiffOperations(
+		const std::string& s1,
+		const std::string& s2,
+		const DiffOptions& options = DiffOptions())
+	{
+		return MaterializeOperations(GetDiffOperationViews(s1, s2, options));
+	}
+
+	/**
+	 * @brief 计算两个字符串的差异操作序列，操作按位置顺序逐个交给回调
+	 * 单线程时每个差异块完成后立即输出，不生成完整的操作数组
+	 * @param s1 源字符串
+	 * @param s2 目标字符串
+	 * @param callback 接收操作的回调（按位置顺序调用）
+	 * @param options 差异算法选项（默认Myers）
+	 */
+	inline void GetDiffOperations(
+		const std::string& s1,
+		const std::string& s2,
+		const std::function<void(StringOperation&&)>& callback,
+		const DiffOptions& options = DiffOptions())
+	{
+		_diff_operation_views(s1, s2, options,
+			[&callback](StringOperationRef&& op) { callback(op.ToOperation()); });
+	}
+
+	/**
+	 * @brief 64位字节串哈希（MurmurHash64A）
+	 */
+	inline uint64_t _hash_bytes64(std::string_view bytes, uint64_t seed = 0xC70F6907ULL) noexcept
+	{
+		constexpr uint64_t m = 0xC6A4A7935BD1E995ULL;
+		constexpr int r = 47;
+		const size_t length = bytes.length();
+		const char* data = bytes.data();
+		uint64_t h = seed ^ (length * m);
+
+		const size_t blocks = length / 8;
+		for (size_t i = 0; i < blocks; ++i)
+		{
+			uint64_t k;
+			std::memcpy(&k, data + i * 8, 8);
+			k *= m;
+			k ^= k >> r;
+			k *= m;
+			h ^= k;
+			h *= m;
+		}
+
+		const unsigned char* tail = reinterpret_cast<const unsigned char*>(data + blocks * 8);
+		switch (length & 7)
+		{
+		case 7: h ^= static_cast<uint64_t>(tail[6]) << 48; [[fallthrough]];
+		case 6: h ^= static_cast<uint64_t>(tail[5]) << 40; [[fallthrough]];
+		case 5: h ^= static_cast<uint64_t>(tail[4]) << 32; [[fallthrough]];
+		case 4: h ^= static_cast<uint64_t>(tail[3]) << 24; [[fallthrough]];
+		case 3: h ^= static_cast<uint64_t>(tail[2]) << 16; [[fallthrough]];
+		case 2: h ^= static_cast<uint64_t>(tail[1]) << 8; [[fallthrough]];
+		case 1: h ^= static_cast<uint64_t>(tail[0]);
+			h *= m;
+			break;
+		default:
+			break;
+		}
+
+		h ^= h >> r;
+		h *= m;
+		h ^= h >> r;
+		return h;
+	}
+
+	/**
+	 * @brief 预处理过的差异基准文本
+	 * 构造时一次性完成分行、64位哈希与编号，之后每次比较只需处理变体文本，
+	 * 行比较变为整数比较。哈希相同但内容不同的行会被检测并分配不同编号。
+	 * 构造后不再修改，多个线程可以同时对同一对象调用GetDiffOperations
+	 */
+	class PreparedDiffBase
+	{
+	private:
+		std::string base;
+		std::vector<_LineSpan> spans;
+		std::vector<uint32_t> ids;
+		std::vector<std::string_view> token_text;                  // 编号对应的行内容
+		std::unordered_map<uint64_t, uint32_t> token_of_hash;      // 哈希到编号
+		std::unordered_map<std::string_view, uint32_t> collisions; // 哈希冲突的行，按内容查找
+
+		uint32_t FindToken(std::string_view line, uint64_t hash) const
+		{
+			auto iter = token_of_hash.find(hash);
+			if (iter != token_of_hash.end() && token_text[iter->second] == line)
+				return iter->second;
+			if (!collisions.empty())
+			{
+				auto collision = collisions.find(line);
+				if (collision != collisions.end())
+					return collision->second;
+			}
+			return UINT32_MAX;
+		}
+
+	public:
+		explicit PreparedDiffBase(std::string text) : base(std::move(text))
+		{
+			spans = _split_line_spans(base);
+			ids.reserve(spans.size());
+			token_of_hash.reserve(spans.size());
+			for (const auto& span : spans)
+			{
+				const std::string_view line(base.data() + span.offset, span.length);
+				const uint64_t hash = _hash_bytes64(line);
+				uint32_t id = FindToken(line, hash);
+				if (id == UINT32_MAX)
+				{
+					id = static_cast<uint32_t>(token_text.size());
+					token_text.push_back(line);
+					if (!token_of_hash.emplace(hash, id).second)
+						collisions.emplace(line, id);
+				}
+				ids.push_back(id);
+			}
+		}
+		PreparedDiffBase(const PreparedDiffBase&) = delete;
+		PreparedDiffBase& operator=(const PreparedDiffBase&) = delete;
+
+		const std::string& GetBase() const noexcept
+		{
+			return base;
+		}
+		size_t GetLineCount() const noexcept
+		{
+			return spans.size();
+		}
+
+		/**
+		 * @brief 计算基准文本到variant的差异操作序列，操作内容引用基准文本或variant
+		 * 结果与GetDiffOperationViews(GetBase(), variant, options)相同
+		 */
+		std::vector<StringOperationRef> GetDiffOperationViews(std::string_view variant, const DiffOptions& options = DiffOptions()) const
+		{
+			const std::string_view text(base);
+			if (text == variant)
+				return {};
+			if (text.empty())
+				return { StringOperationRef(StringOpType::Add, 0, 0, variant) };
+			if (variant.empty())
+				return { StringOperationRef(StringOpType::Delete, 0, text.length(), text) };
+
+			// 整块剥离公共的首尾行，基准一侧按偏移找到对应的行号
+			size_t prefix = 0, suffix = 0;
+			if (options.algorithm != DiffAlgorithm::LCS)
+				_trim_common_lines(text, variant, prefix, suffix);
+			auto line_at = [this](size_t offset)
+				{
+					return static_cast<size_t>(std::lower_bound(spans.begin(), spans.end(), offset,
+						[](const _LineSpan& span, size_t value) { return span.offset < value; }) - spans.begin());
+				};
+			const size_t line_lo = line_at(prefix);
+			const size_t line_hi = suffix == 0 ? spans.size() : line_at(text.length() - suffix);
+
+			// 只对变体的中间部分分行编号；基准中不存在的行使用局部的新编号
+			std::vector<_LineSpan> variant_spans = _split_line_spans(variant, prefix, suffix);
+			std::vector<uint32_t> variant_ids;
+			variant_ids.reserve(variant_spans.size());
+			std::unordered_map<std::string_view, uint32_t> local;
+			for (const auto& span : variant_spans)
+			{
+				const std::string_view line(variant.data() + span.offset, span.length);
+				uint32_t id = FindToken(line, _hash_bytes64(line));
+				if (id == UINT32_MAX)
+					id = local.try_emplace(line, static_cast<uint32_t>(token_text.size() + local.size())).first->second;
+				variant_ids.push_back(id);
+			}
+
+			_LineSpanRange range1(text, spans.data() + line_lo, line_hi - line_lo, suffix == 0, text.length() - suffix);
+			_LineSpanRange range2(variant, variant_spans.data(), variant_spans.size(), suffix == 0, variant.length() - suffix);
+			return _diff_line_ranges(range1, range2, ids.data() + line_lo, variant_ids.data(), options);
+		}
+
+		/**
+		 * @brief 计算基准文本到variant的差异操作序列
+		 */
+		std::vector<StringOperation> GetDiffOperations(std::string_view variant, const DiffOptions& options = DiffOptions()) const
+		{
+			return MaterializeOperations(GetDiffOperationViews(variant, options));
+		}
+	};
+
+	/**
+	 * @brief 并行计算同一基准文本到多个变体的差异操作序列
+	 * 各线程共享预处理过的基准，每个变体的结果与GetDiffOperations(base, variant, options)相同
+	 * @param base 预处理过的基准文本
+	 * @param variants 变体数组
+	 * @param count 变体数量
+	 * @param options 差异算法选项（单个变体内部不再并行）
+	 * @param thread_count 工作线程数，0为硬件线程数
+	 * @return 与variants一一对应的操作序列
+	 */
+	inline std::vector<std::vector<StringOperation>> GetDiffOperationsBatch(
+		const PreparedDiffBase& base,
+		const std::string* variants,
+		size_t count,
+		const DiffOptions& options = DiffOptions(),
+		size_t thread_count = 0)
+	{
+		if (thread_count == 0)
+			thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+		DiffOptions variant_options = options;
+		variant_options.thread_count = 1;
+
+		std::vector<std::vector<StringOperation>> results(count);
+		_run_parallel(count, thread_count, [&](size_t index)
+			{
+				results[index] = base.GetDiffOperations(variants[index], variant_options);
+			});
+		return results;
+	}
+
+	inline std::vector<std::vector<StringOperation>> GetDiffOperationsBatch(
+		const std::string& base,
+		const std::string* variants,
+		size_t count,
+		const DiffOptions& options = DiffOptions(),
+		size_t thread_count = 0)
+	{
+		const PreparedDiffBase prepared(base);
+		return GetDiffOperationsBatch(prepared, variants, count, options, thread_count);
+	}
+
+	inline std::vector<std::vector<StringOperation>> GetDiffOperationsBatch(
+		const std::string& base,
+		const std::vector<std::string>& variants,
+		const DiffOptions& options = DiffOptions(),
+		size_t thread_count = 0)
+	{
+		return GetDiffOperationsBatch(base, variants.data(), variants.size(), options, thread_count);
+	}
+
+	/**
+	 * @brief 近似查找的一个结果
+	 */
+	struct FuzzyMatch
+	{
+		size_t index;  // 键在索引中的下标
+		int distance;  // 编辑距离（仅插入/删除，与GetEditorDistance口径相同）
+	};
+
+	/**
+	 * @brief 按编辑距离近似查找字符串的q-gram倒排索引
+	 * 距离不超过k的两个串至少共有max(|x|, |y|) - q + 1 - k * q个q-gram（按多重集计），
+	 * 查询时先按长度与q-gram计数过滤出候选，再用带状距离内核逐个验证。
+	 * 查询串过短或k过大导致计数下界不为正时，退化为按长度范围扫描。
+	 * 构造后不再修改，多个线程可以同时查询
+	 */
+	class FuzzyStringIndex
+	{
+	private:
+		using GramCount = std::pair<uint64_t, uint32_t>;  // (q-gram, 出现次数)
+		using Posting = std::pair<uint32_t, uint32_t>;    // (键下标, 该q-gram在键中的出现次数)
+		using PostingMap = std::unordered_map<uint64_t, std::vector<Posting>>;
+
+		std::vector<std::string> keys;
+		size_t q;
+		std::vector<PostingMap> shards;   // 按q-gram分片的倒排表，每个列表按键下标递增
+		std::vector<uint32_t> by_length;  // 按长度排序的键下标
+
+		/**
+		 * @brief 统计text中各q-gram的出现次数，q-gram按字节打包为整数
+		 */
+		static std::vector<GramCount> CountGrams(std::string_view text, size_t q)
+		{
+			std::vector<uint64_t> grams;
+			if (text.length() >= q)
+				grams.reserve(text.length() - q + 1);
+			for (size_t i = 0; i + q <= text.length(); ++i)
+			{
+				uint64_t gram = 0;
+				for (size_t j = 0; j < q; ++j)
+					gram = (gram << 8) | static_cast<unsigned char>(text[i + j]);
+				grams.push_back(gram);
+			}
+			std::sort(grams.begin(), grams.end());
+
+			std::vector<GramCount> counts;
+			for (size_t i = 0; i < grams.size();)
+			{
+				size_t next = i + 1;
+				while (next < grams.size() && grams[next] == grams[i])
+					++next;
+				counts.emplace_back(grams[i], static_cast<uint32_t>(next - i));
+				i = next;
+			}
+			return counts;
+		}
+
+	public:
+		/**
+		 * @brief 建立索引
+		 * 各线程先为连续的一段键建立局部倒排表，再按分片并行合并，合并时按段的顺序追加
+		 * @param keys 被查找的键
+		 * @param q q-gram的长度，取值[1, 8]
+		 * @param thread_count 建立索引的线程数，0为硬件线程数
+		 */
+		explicit FuzzyStringIndex(std::vector<std::string> keys, size_t q = 3, size_t thread_count = 0)
+			: keys(std::move(keys)), q(q)
+		{
+			if (q == 0 || q > 8)
+				throw std::invalid_argument("q must be in [1, 8]");
+			if (this->keys.size() > UINT32_MAX)
+				throw std::invalid_argument("too many keys");
+			if (thread_count == 0)
+				thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+			const size_t key_count = this->keys.size();
+			const size_t chunk_count = std::min(thread_count, key_count);
+			const size_t shard_count = thread_count;
+			std::vector<std::vector<PostingMap>> local(chunk_count, std::vector<PostingMap>(shard_count));
+			_run_parallel(chunk_count, thread_count, [&](size_t chunk)
+				{
+					auto& maps = local[chunk];
+					const size_t lo = key_count * chunk / chunk_count;
+					const size_t hi = key_count * (chunk + 1) / chunk_count;
+					for (size_t id = lo; id < hi; ++id)
+					{
+						for (const auto& [gram, count] : CountGrams(this->keys[id], q))
+							maps[gram % shard_count][gram].emplace_back(static_cast<uint32_t>(id), count);
+					}
+				});
+
+			shards.resize(shard_count);
+			_run_parallel(shard_count, thread_count, [&](size_t shard)
+				{
+					auto& target = shards[shard];
+					for (auto& maps : local)
+					{
+						for (auto& [gram, postings] : maps[shard])
+						{
+							auto& list = target[gram];
+							list.insert(list.end(), postings.begin(), postings.end());
+						}
+						PostingMap().swap(maps[shard]);
+					}
+				});
+
+			by_length.resize(key_count);
+			std::iota(by_length.begin(), by_length.end(), 0u);
+			std::stable_sort(by_length.begin(), by_length.end(),
+				[this](uint32_t a, uint32_t b) { return this->keys[a].length() < this->keys[b].length(); });
+		}
+		FuzzyStringIndex(const FuzzyStringIndex&) = delete;
+		FuzzyStringIndex& operator=(const FuzzyStringIndex&) = delete;
+
+		size_t GetKeyCount() const noexcept
+		{
+			return keys.size();
+		}
+		const std::string& GetKey(size_t index) const
+		{
+			return keys.at(index);
+		}
+
+		/**
+		 * @brief 查找与query的编辑距离不超过k的全部键
+		 * @param query 查询串
+		 * @param k 距离阈值（不能为负）
+		 * @return 匹配结果，按距离、再按键下标排序
+		 */
+		std::vector<FuzzyMatch> Find(std::string_view query, int k) const
+		{
+			if (k < 0)
+				throw std::invalid_argument("k must be non-negative");
+
+			const size_t bound = static_cast<size_t>(k);
+			std::vector<FuzzyMatch> result;
+			auto verify = [&](uint32_t id)
+				{
+					const std::string& key = keys[id];
+					const size_t diff = key.length() > query.length() ? key.length() - query.length() : query.length() - key.length();
+					if (diff > bound)
+						return;
+					const int distance = GetEditorDistanceBounded(key, query, k);
+					if (distance <= k)
+						result.push_back({ id, distance });
+				};
+			// 与长度为length的键共有的q-gram数量下界
+			auto shared_bound = [&](size_t length)
+				{
+					return static_cast<int64_t>(std::max(length, query.length())) - static_cast<int64_t>(q) + 1
+						- static_cast<int64_t>(bound * q);
+				};
+
+			if (shared_bound(0) <= 0)
+			{
+				// 计数过滤不起作用，只按长度过滤
+				const size_t min_length = query.length() > bound ? query.length() - bound : 0;
+				auto iter = std::lower_bound(by_length.begin(), by_length.end(), min_length,
+					[this](uint32_t id, size_t length) { return keys[id].length() < length; });
+				for (; iter != by_length.end() && keys[*iter].length() <= query.length() + bound; ++iter)
+					verify(*iter);
+			}
+			else
+			{
+				// 查询串的q-gram按倒排列表长度从短到长处理: 共有数量达到下界的键至少出现在
+				// 最短的若干个列表中（出现次数合计超过total - minimum），其余列表只用于估计上界
+				struct GramPostings
+				{
+					uint32_t count;
+					const std::vector<Posting>* postings;
+				};
+				std::vector<GramPostings> grams;
+				int64_t total = 0;
+				int64_t covered = 0;  // 已处理列表对应的出现次数，没有任何键包含的q-gram直接计入
+				for (const auto& [gram, count] : CountGrams(query, q))
+				{
+					total += count;
+					const PostingMap& shard = shards[gram % shards.size()];
+					auto postings = shard.find(gram);
+					if (postings != shard.end())
+						grams.push_back({ count, &postings->second });
+					else
+						covered += count;
+				}
+				std::sort(grams.begin(), grams.end(), [](const GramPostings& a, const GramPostings& b)
+					{
+						return a.postings->size() < b.postings->size();
+					});
+
+				// 累计每个键在候选列表中的共有数量
+				const int64_t minimum = shared_bound(0);
+				std::unordered_map<uint32_t, uint32_t> shared;
+				for (const auto& gram : grams)
+				{
+					if (covered > total - minimum)
+						break;
+					covered += gram.count;
+					for (const auto& [id, key_count] : *gram.postings)
+						shared[id] += std::min(gram.count, key_count);
+				}
+				for (const auto& [id, count] : shared)
+				{
+					if (static_cast<int64_t>(count) + (total - covered) >= shared_bound(keys[id].length()))
+						verify(id);
+				}
+			}
+
+			std::sort(result.begin(), result.end(), [](const FuzzyMatch& a, const FuzzyMatch& b)
+				{
+					return a.distance != b.distance ? a.distance < b.distance : a.index < b.index;
+				});
+			return result;
+		}
+	};
+
+	/**
+	 * @brief 流式计算两段文本的差异操作序列（内存有界）
+	 * 相同的行直接跳过；遇到差异时最多各读入options.streaming_window_lines行，
+	 * 只提交窗口前部已确定的差异块，随后继续向后推进。
+	 * 每个差异块完成后立即通过回调输出，操作格式与GetDiffOperations一致。
+	 * 差异跨越整个窗口时结果仍然正确，但可能不是全局最短的。
+	 * 此模式下LCS算法按Myers处理
+	 * @param s1 源文本
+	 * @param s2 目标文本
+	 * @param callback 接收操作的回调（按位置顺序调用）
+	 * @param options 差异算法选项
+	 */
+	inline void GetDiffOperationsStreaming(
+		std::string_view s1,
+		std::string_view s2,
+		const std::function<void(StringOperation&&)>& callback,
+		const DiffOptions& options = DiffOptions())
+	{
+		if (s1 == s2)
+			return;
+		if (s1.empty())
+		{
+			callback(StringOperation(StringOpType::Add, 0, 0, std::string(s2)));
+			return;
+		}
+		if (s2.empty())
+		{
+			callback(StringOperation(StringOpType::Delete, 0, s1.length(), std::string(s1)));
+			return;
+		}
+
+		DiffOptions window_options = options;
+		if (window_options.algorithm == DiffAlgorithm::LCS)
+			window_options.algorithm = DiffAlgorithm::Myers;
+		const size_t window = std::max<size_t>(options.streaming_window_lines, 2);
+
+		// 跨窗口相接的删除先暂存合并: 删除延伸到文本末尾时，需要连同这一整段之前的换行符一起删除
+		std::optional<std::pair<size_t, size_t>> pending_delete;
+		size_t emitted_end = 0;  // 已输出操作覆盖到的位置
+		auto flush_delete = [&]()
+			{
+				if (pending_delete)
+				{
+					const auto [begin, end] = *pending_delete;
+					callback(StringOperation(StringOpType::Delete, begin, end, std::string(s1.substr(begin, end - begin))));
+					emitted_end = end;
+					pending_delete.reset();
+				}
+			};
+		auto emit = [&](StringOperationRef&& op)
+			{
+				if (op.type == StringOpType::Delete)
+				{
+					if (pending_delete && op.start == pending_delete->second)
+					{
+						pending_delete->second = op.end;
+						return;
+					}
+					if (pending_delete && op.start + 1 == pending_delete->second && op.end == s1.length())
+					{
+						// 末尾删除已包含前一行的换行符，而该行本身也在暂存的删除中
+						if (pending_delete->first > emitted_end)
+							--pending_delete->first;
+						pending_delete->second = op.end;
+						return;
+					}
+					flush_delete();
+					pending_delete.emplace(op.start, op.end);
+					return;
+				}
+				flush_delete();
+				emitted_end = op.start;
+				callback(op.ToOperation());
+			};
+
+		size_t pos1 = 0, pos2 = 0;     // 下一行的起点
+		bool done1 = false, done2 = false;
+		std::vector<_LineSpan> window1, window2;
+		std::vector<uint32_t> ids1, ids2;
+		window1.reserve(window);
+		window2.reserve(window);
+
+		auto load = [](std::string_view text, size_t pos, bool done, size_t limit, std::vector<_LineSpan>& spans)
+			{
+				spans.clear();
+				while (!done && spans.size() < limit)
+				{
+					spans.push_back(_read_line_span(text, pos, done));
+					pos = spans.back().End() + 1;
+				}
+				return done;
+			};
+
+		while (true)
+		{
+			// 跳过相同的行: 先整块比较字节并跳过公共前缀中的完整行，剩余部分逐行比较
+			if (!done1 && !done2)
+			{
+				const size_t common = _common_prefix_length(s1.substr(pos1), s2.substr(pos2));
+				const size_t newline = common == 0 ? std::string_view::npos : s1.rfind('\n', pos1 + common - 1);
+				if (newline != std::string_view::npos && newline >= pos1)
+				{
+					pos2 += newline + 1 - pos1;
+					pos1 = newline + 1;
+				}
+			}
+			while (!done1 && !done2)
+			{
+				bool end1 = false, end2 = false;
+				const _LineSpan line1 = _read_line_span(s1, pos1, end1);
+				const _LineSpan line2 = _read_line_span(s2, pos2, end2);
+				if (s1.substr(line1.offset, line1.length) != s2.substr(line2.offset, line2.length))
+					break;
+				pos1 = line1.End() + 1;
+				pos2 = line2.End() + 1;
+				done1 = end1;
+				done2 = end2;
+			}
+			if (done1 && done2)
+				break;
+
+			// 读入窗口并计算窗口内的匹配段
+			const bool eof1 = load(s1, pos1, done1, window, window1);
+			const bool eof2 = load(s2, pos2, done2, window, window2);
+			const size_t count1 = window1.size();
+			const size_t count2 = window2.size();
+			_intern_line_spans(s1, window1.data(), count1, s2, window2.data(), count2, ids1, ids2);
+			auto matches = _diff_token_ids(ids1.data(), count1, ids2.data(), count2, window_options);
+
+			_LineSpanRange range1{ s1, window1.data(), count1, eof1 };
+			_LineSpanRange range2{ s2, window2.data(), count2, eof2 };
+
+			if (eof1 && eof2)
+			{
+				_emit_line_matches(range1, range2, matches, count1, count2, options, emit);
+				break;
+			}
+
+			// 靠近窗口尾部的对齐可能因窗口外的内容而改变，只提交前3/4范围内的匹配
+			const size_t limit1 = eof1 ? count1 : count1 - count1 / 4;
+			const size_t limit2 = eof2 ? count2 : count2 - count2 / 4;
+			std::vector<_DiffMatch> committed;
+			for (const auto& match : matches)
+			{
+				if (match.a >= limit1 || match.b >= limit2)
+					break;
+				const size_t length = std::min({ match.length, limit1 - match.a, limit2 - match.b });
+				committed.push_back({ match.a, match.b, length });
+				if (length < match.length)
+					break;
+			}
+
+			size_t advance1 = 0, advance2 = 0;
+			if (!committed.empty())
+			{
+				advance1 = committed.back().a + committed.back().length;
+				advance2 = committed.back().b + committed.back().length;
+			}
+			else
+			{
+				// 窗口前部没有公共行: 未到末尾的一侧提交一半窗口以保证推进
+				advance1 = eof1 ? 0 : std::max<size_t>(1, count1 / 2);
+				advance2 = eof2 ? 0 : std::max<size_t>(1, count2 / 2);
+			}
+			_emit_line_matches(range1, range2, committed, advance1, advance2, options, emit);
+
+			// 推进到已提交部分之后
+			if (advance1 < count1)
+			{
+				pos1 = window1[advance1].offset;
+				done1 = false;
+			}
+			else if (count1 > 0)
+			{
+				pos1 = window1.back().End() + 1;
+				done1 = eof1;
+			}
+			if (advance2 < count2)
+			{
+				pos2 = window2[advance2].offset;
+				done2 = false;
+			}
+			else if (count2 > 0)
+			{
+				pos2 = window2.back().End() + 1;
+				done2 = eof2;
+			}
+		}
+		flush_delete();
+	}
+
+	/**
+	 * @brief 流式比较两个文件（内存映射，不整体读入）
+	 * @param file1 源文件
+	 * @param file2 目标文件
+	 * @param callback 接收操作的回调（按位置顺序调用）
+	 * @param options 差异算法选项
+	 * @note 与文本版本分开命名: ToolFile可由std::string与const char*隐式构造，同名重载会产生歧义
+	 */
+	inline void GetFileDiffOperationsStreaming(
+		const ToolFile& file1,
+		const ToolFile& file2,
+		const std::function<void(StringOperation&&)>& callback,
+		const DiffOptions& options = DiffOptions())
+	{
+		ToolFileMapping mapping1 = file1.MapAsReadOnly();
+		ToolFileMapping mapping2 = file2.MapAsReadOnly();
+		GetDiffOperationsStreaming(mapping1.GetView(), mapping2.GetView(), callback, options);
+	}
+
+	/**
+	 * @brief 三方合并中的一处冲突
+	 */
+	struct MergeConflict
+	{
+		size_t base_start;  // 冲突区域在base中的起始位置
+		size_t base_end;    // 冲突区域在base中的结束位置
+		size_t start;       // 冲突标记块在合并结果中的起始位置
+		size_t end;         // 冲突标记块在合并结果中的结束位置
+	};
+
+	/**
+	 * @brief 三方合并的结果
+	 */
+	struct MergeResult
+	{
+		std::string content;                   // 合并后的文本，冲突处为git风格的标记块
+		std::vector<MergeConflict> conflicts;  // 冲突位置，按位置排列
+
+		bool HasConflicts() const noexcept
+		{
+			return !conflicts.empty();
+		}
+	};
+
+	/**
+	 * @brief 一侧对base的一处连续修改: 将base[start, end)替换为replacement
+	 */
+	struct _MergeChange
+	{
+		size_t start;
+		size_t end;
+		std::string replacement;
+		size_t footprint_start;  // 所在整行范围，用于判定冲突；行首的纯插入为空区间
+		size_t footprint_end;
+		bool ours;
+	};
+
+	/**
+	 * @brief 将操作序列中首尾相接的操作归并为修改块，并计算其整行范围
+	 */
+	inline std::vector<_MergeChange> _collect_merge_changes(
+		std::string_view base,
+		const std::vector<StringOperationRef>& operations,
+		bool ours)
+	{
+		std::vector<_MergeChange> changes;
+		for (const auto& op : operations)
+		{
+			if (changes.empty() || changes.back().end != op.start)
+				changes.push_back({ op.start, op.start, std::string(), 0, 0, ours });
+			auto& change = changes.back();
+			if (op.type == StringOpType::Delete)
+				change.end = op.end;
+			else
+				change.replacement.append(op.content.data(), op.content.length());
+		}
+		for (auto& change : changes)
+		{
+			// 行首的纯插入不占用任何行，范围为行边界上的空区间
+			if (change.end == change.start && (change.start == 0 || base[change.start - 1] == '\n'))
+			{
+				change.footprint_start = change.footprint_end = change.start;
+				continue;
+			}
+			const size_t line_begin = change.start == 0 ? std::string_view::npos : base.rfind('\n', change.start - 1);
+			change.footprint_start = line_begin == std::string_view::npos ? 0 : line_begin + 1;
+			// 以换行符结尾的删除止于该换行符之后，否则延伸到所在行的行尾
+			if (change.end > change.start && base[change.end - 1] == '\n')
+				change.footprint_end = change.end;
+			else
+			{
+				const size_t line_end = base.find('\n', change.end);
+				change.footprint_end = line_end == std::string_view::npos ? base.length() : line_end + 1;
+			}
+		}
+		return changes;
+	}
+
+	/**
+	 * @brief 三方合并: 将base到ours与base到theirs的修改合并到一起
+	 * 两侧的修改落在同一行（或相邻的插入点）时，若结果相同则直接采用，
+	 * 否则输出git风格的冲突标记块并记录冲突位置。
+	 * 耗时为两次GetDiffOperations加上一次线性扫描
+	 * @param base 共同祖先
+	 * @param ours 本方版本
+	 * @param theirs 对方版本
+	 * @param options 差异算法选项
+	 * @return 合并结果与冲突位置
+	 */
+	inline MergeResult Merge3(
+		const std::string& base,
+		const std::string& ours,
+		const std::string& theirs,
+		const DiffOptions& options = DiffOptions())
+	{
+		MergeResult result;
+		if (ours == theirs || theirs == base)
+		{
+			result.content = ours;
+			return result;
+		}
+		if (ours == base)
+		{
+			result.content = theirs;
+			return result;
+		}
+
+		auto changes = _collect_merge_changes(base, GetDiffOperationViews(base, ours, options), true);
+		auto theirs_changes = _collect_merge_changes(base, GetDiffOperationViews(base, theirs, options), false);
+		const size_t ours_count = changes.size();
+		changes.insert(changes.end(), std::make_move_iterator(theirs_changes.begin()), std::make_move_iterator(theirs_changes.end()));
+		std::inplace_merge(changes.begin(), changes.begin() + ours_count, changes.end(),
+			[](const _MergeChange& left, const _MergeChange& right)
+			{
+				return left.footprint_start < right.footprint_start;
+			});
+
+		// 将[begin, end)中属于一侧的修改应用到base[region_start, region_end)
+		auto apply_side = [&base, &changes](size_t begin, size_t end, size_t region_start, size_t region_end, bool from_ours)
+			{
+				std::string text;
+				size_t cursor = region_start;
+				for (size_t k = begin; k < end; ++k)
+				{
+					const auto& change = changes[k];
+					if (change.ours != from_ours)
+						continue;
+					text.append(base.data() + cursor, change.start - cursor);
+					text.append(change.replacement);
+					cursor = change.end;
+				}
+				text.append(base.data() + cursor, region_end - cursor);
+				return text;
+			};
+
+		result.content.reserve(std::max(ours.length(), theirs.length()));
+		size_t cursor = 0;
+		size_t k = 0;
+		while (k < changes.size())
+		{
+			// 收集整行范围相互重叠的一组修改
+			size_t group_end = k + 1;
+			size_t region_start = changes[k].footprint_start;
+			size_t region_end = changes[k].footprint_end;
+			bool has_ours = changes[k].ours, has_theirs = !changes[k].ours;
+			while (group_end < changes.size() &&
+				(changes[group_end].footprint_start < region_end || changes[group_end].footprint_start == region_start))
+			{
+				region_end = std::max(region_end, changes[group_end].footprint_end);
+				has_ours |= changes[group_end].ours;
+				has_theirs |= !changes[group_end].ours;
+				++group_end;
+			}
+
+			result.content.append(base.data() + cursor, region_start - cursor);
+			std::string ours_text = apply_side(k, group_end, region_start, region_end, true);
+			if (!has_theirs || !has_ours)
+			{
+				result.content += has_ours ? ours_text : apply_side(k, group_end, region_start, region_end, false);
+			}
+			else
+			{
+				std::string theirs_text = apply_side(k, group_end, region_start, region_end, false);
+				if (ours_text == theirs_text)
+				{
+					result.content += ours_text;
+				}
+				else
+				{
+					MergeConflict conflict{ region_start, region_end, result.content.length(), 0 };
+					result.content += "<<<<<<< ours\n";
+					result.content += ours_text;
+					if (!ours_text.empty() && ours_text.back() != '\n')
+						result.content += '\n';
+					result.content += "=======\n";
+					result.content += theirs_text;
+					if (!theirs_text.empty() && theirs_text.back() != '\n')
+						result.content += '\n';
+					result.content += ">>>>>>> theirs\n";
+					conflict.end = result.content.length();
+					result.conflicts.push_back(conflict);
+				}
+			}
+			cursor = region_end;
+			k = group_end;
+		}
+		result.content.append(base.data() + cursor, base.length() - cursor);
+		return result;
+	}
+
+	/**
+	 * @brief 片段表文本缓冲区
+	 * 文本由指向原始缓冲区或追加缓冲区的片段组成，片段按顺序保存在隐式treap中，
+	 * 子树记录总长度与换行符数量。插入只追加到追加缓冲区并拆分片段，删除只移除片段，
+	 * 单次编辑、按行号求偏移、按偏移求行号均为O(log n)，不会复制整个文本。
+	 * 行的划分与_split_lines一致: 行数为换行符数 + 1
+	 */
+	class PieceTable
+	{
+	private:
+		struct Node
+		{
+			bool added;                    // 内容位于追加缓冲区，否则位于原始缓冲区
+			size_t offset;                 // 在缓冲区中的起点
+			size_t length;                 // 片段长度
+			size_t newlines;               // 片段中的换行符数
+			uint64_t priority;
+			size_t total_length = 0;       // 子树总长度
+			size_t total_newlines = 0;     // 子树中的换行符数
+			std::unique_ptr<Node> left, right;
+		};
+
+		std::string original;
+		std::string added;
+		std::vector<size_t> original_newlines;  // 原始缓冲区中换行符的位置
+		std::vector<size_t> added_newlines;     // 追加缓冲区中换行符的位置
+		std::unique_ptr<Node> root;
+		uint64_t random_state = 0x9E3779B97F4A7C15ULL;
+
+		static size_t TotalLength(const std::unique_ptr<Node>& node) noexcept
+		{
+			return node ? node->total_length : 0;
+		}
+		static size_t TotalNewlines(const std::unique_ptr<Node>& node) noexcept
+		{
+			return node ? node->total_newlines : 0;
+		}
+		static void Update(Node& node) noexcept
+		{
+			node.total_length = TotalLength(node.left) + node.length + TotalLength(node.right);
+			node.total_newlines = TotalNewlines(node.left) + node.newlines + TotalNewlines(node.right);
+		}
+
+		static void RecordNewlines(std::string_view text, size_t base, std::vector<size_t>& positions)
+		{
+			for (size_t pos = text.find('\n'); pos != std::string_view::npos; pos = text.find('\n', pos + 1))
+				positions.push_back(base + pos);
+		}
+
+		const std::string& BufferOf(const Node& node) const noexcept
+		{
+			return node.added ? added : original;
+		}
+		const std::vector<size_t>& NewlinesOf(const Node& node) const noexcept
+		{
+			return node.added ? added_newlines : original_newlines;
+		}
+		std::string_view ViewOf(const Node& node) const noexcept
+		{
+			return std::string_view(BufferOf(node)).substr(node.offset, node.length);
+		}
+		/**
+		 * @brief 缓冲区[offset, offset + length)中的换行符数（二分查找）
+		 */
+		static size_t CountNewlines(const std::vector<size_t>& positions, size_t offset, size_t length) noexcept
+		{
+			return static_cast<size_t>(std::lower_bound(positions.begin(), positions.end(), offset + length)
+				- std::lower_bound(positions.begin(), positions.end(), offset));
+		}
+
+		std::unique_ptr<Node> MakeNode(bool is_added, size_t offset, size_t length)
+		{
+			// xorshift64*
+			random_state ^= random_state >> 12;
+			random_state ^= random_state << 25;
+			random_state ^= random_state >> 27;
+			auto node = std::make_unique<Node>();
+			node->added = is_added;
+			node->offset = offset;
+			node->length = length;
+			node->newlines = CountNewlines(is_added ? added_newlines : original_newlines, offset, length);
+			node->priority = random_state * 0x2545F4914F6CDD1DULL;
+			Update(*node);
+			return node;
+		}
+
+		static std::unique_ptr<Node> Merge(std::unique_ptr<Node> left, std::unique_ptr<Node> right)
+		{
+			if (!left)
+				return right;
+			if (!right)
+				return left;
+			if (left->priority > right->priority)
+			{
+				left->right = Merge(std::move(left->right), std::move(right));
+				Update(*left);
+				return left;
+			}
+			right->left = Merge(std::move(left), std::move(right->left));
+			Update(*right);
+			return right;
+		}
+
+		/**
+		 * @brief 把node拆分为前pos个字节与其余部分，pos落在片段内部时拆分该片段
+		 */
+		void Split(std::unique_ptr<Node> node, size_t pos, std::unique_ptr<Node>& left, std::unique_ptr<Node>& right)
+		{
+			if (!node)
+			{
+				left.reset();
+				right.reset();
+				return;
+			}
+			const size_t left_length = TotalLength(node->left);
+			if (pos <= left_length)
+			{
+				std::unique_ptr<Node> rest;
+				Split(std::move(node->left), pos, left, rest);
+				node->left = std::move(rest);
+				Update(*node);
+				right = std::move(node);
+			}
+			else if (pos >= left_length + node->length)
+			{
+				std::unique_ptr<Node> rest;
+				Split(std::move(node->right), pos - left_length - node->length, rest, right);
+				node->right = std::move(rest);
+				Update(*node);
+				left = std::move(node);
+			}
+			else
+			{
+				// 片段前半部分留在node中，后半部分成为右侧的第一个片段
+				const size_t cut = pos - left_length;
+				auto tail = MakeNode(node->added, node->offset + cut, node->length - cut);
+				node->length = cut;
+				node->newlines -= tail->newlines;
+				std::unique_ptr<Node> rest = std::move(node->right);
+				Update(*node);
+				left = std::move(node);
+				right = Merge(std::move(tail), std::move(rest));
+			}
+		}
+
+		/**
+		 * @brief 按顺序访问与[begin, end)相交的片段部分，visit返回false时停止
+		 * @param node_begin node子树在文本中的起点
+		 * @return 是否访问完毕（未被visit中止）
+		 */
+		template<typename Visit>
+		bool VisitRange(const Node* node, size_t node_begin, size_t begin, size_t end, Visit&& visit) const
+		{
+			if (!node || begin >= end || node_begin >= end || node_begin + node->total_length <= begin)
+				return true;
+			const size_t piece_begin = node_begin + TotalLength(node->left);
+			if (!VisitRange(node->left.get(), node_begin, begin, end, visit))
+				return false;
+			const size_t first = std::max(begin, piece_begin);
+			const size_t last = std::min(end, piece_begin + node->length);
+			if (first < last && !visit(ViewOf(*node).substr(first - piece_begin, last - first)))
+				return false;
+			return VisitRange(node->right.get(), piece_begin + node->length, begin, end, visit);
+		}
+
+		/**
+		 * @brief 逆序访问全部片段，visit返回false时停止
+		 */
+		template<typename Visit>
+		bool VisitBackward(const Node* node, Visit&& visit) const
+		{
+			if (!node)
+				return true;
+			return VisitBackward(node->right.get(), visit)
+				&& visit(ViewOf(*node))
+				&& VisitBackward(node->left.get(), visit);
+		}
+
+		/**
+		 * @brief 校验按base位置排列的操作序列，并从后向前应用，使前面的位置不受影响
+		 */
+		template<typename Operation>
+		void ApplyInReverse(const std::vector<Operation>& operations)
+		{
+			const size_t length = GetLength();
+			size_t cursor = 0;
+			for (const auto& op : operations)
+			{
+				if (op.start < cursor || op.end < op.start || op.end > length)
+					throw std::invalid_argument("operations are out of order or out of range");
+				cursor = op.type == StringOpType::Delete ? op.end : op.start;
+			}
+			for (auto iter = operations.rbegin(); iter != operations.rend(); ++iter)
+			{
+				if (iter->type == StringOpType::Delete)
+					Erase(iter->start, iter->end - iter->start);
+				else
+					Insert(iter->start, iter->content);
+			}
+		}
+
+	public:
+		PieceTable() = default;
+		explicit PieceTable(std::string text) : original(std::move(text))
+		{
+			RecordNewlines(original, 0, original_newlines);
+			if (!original.empty())
+				root = MakeNode(false, 0, original.length());
+		}
+		PieceTable(const PieceTable&) = delete;
+		PieceTable& operator=(const PieceTable&) = delete;
+		PieceTable(PieceTable&&) noexcept = default;
+		PieceTable& operator=(PieceTable&&) noexcept = default;
+
+		size_t GetLength() const noexcept
+		{
+			return TotalLength(root);
+		}
+		size_t GetLineCount() const noexcept
+		{
+			return TotalNewlines(root) + 1;
+		}
+
+		/**
+		 * @brief 在pos处插入text
+		 */
+		void Insert(size_t pos, std::string_view text)
+		{
+			if (pos > GetLength())
+				throw std::out_of_range("insert position is out of range");
+			if (text.empty())
+				return;
+			const size_t offset = added.length();
+			added.append(text.data(), text.length());
+			RecordNewlines(text, offset, added_newlines);
+
+			std::unique_ptr<Node> left, right;
+			Split(std::move(root), pos, left, right);
+			root = Merge(Merge(std::move(left), MakeNode(true, offset, text.length())), std::move(right));
+		}
+
+		/**
+		 * @brief 删除[pos, pos + length)
+		 */
+		void Erase(size_t pos, size_t length)
+		{
+			if (pos > GetLength() || length > GetLength() - pos)
+				throw std::out_of_range("erase range is out of range");
+			if (length == 0)
+				return;
+			std::unique_ptr<Node> left, middle, right;
+			Split(std::move(root), pos, left, right);
+			Split(std::move(right), length, middle, right);
+			root = Merge(std::move(left), std::move(right));
+		}
+
+		/**
+		 * @brief 第line行（从0开始）的起始偏移
+		 */
+		size_t GetLineStart(size_t line) const
+		{
+			if (line >= GetLineCount())
+				throw std::out_of_range("line is out of range");
+			if (line == 0)
+				return 0;
+
+			// 找到第line个换行符，行从其后开始
+			size_t remaining = line;
+			size_t base = 0;
+			const Node* node = root.get();
+			while (true)
+			{
+				const size_t left_newlines = TotalNewlines(node->left);
+				if (remaining <= left_newlines)
+				{
+					node = node->left.get();
+					continue;
+				}
+				remaining -= left_newlines;
+				base += TotalLength(node->left);
+				if (remaining <= node->newlines)
+				{
+					const auto& positions = NewlinesOf(*node);
+					const size_t first = static_cast<size_t>(std::lower_bound(positions.begin(), positions.end(), node->offset) - positions.begin());
+					return base + (positions[first + remaining - 1] - node->offset) + 1;
+				}
+				remaining -= node->newlines;
+				base += node->length;
+				node = node->right.get();
+			}
+		}
+
+		/**
+		 * @brief 偏移pos所在的行号（即[0, pos)中的换行符数）
+		 */
+		size_t GetLineOfOffset(size_t pos) const
+		{
+			if (pos > GetLength())
+				throw std::out_of_range("offset is out of range");
+			size_t line = 0;
+			const Node* node = root.get();
+			while (node && pos > 0)
+			{
+				const size_t left_length = TotalLength(node->left);
+				if (pos <= left_length)
+				{
+					node = node->left.get();
+					continue;
+				}
+				line += TotalNewlines(node->left);
+				pos -= left_length;
+				if (pos <= node->length)
+					return line + CountNewlines(NewlinesOf(*node), node->offset, pos);
+				line += node->newlines;
+				pos -= node->length;
+				node = node->right.get();
+			}
+			return line;
+		}
+
+		/**
+		 * @brief 按顺序访问[pos, pos + length)对应的各片段内容，visit(std::string_view)返回false时停止
+		 */
+		template<typename Visit>
+		void ForEachPiece(size_t pos, size_t length, Visit&& visit) const
+		{
+			if (pos > GetLength() || length > GetLength() - pos)
+				throw std::out_of_range("range is out of range");
+			VisitRange(root.get(), 0, pos, pos + length, visit);
+		}
+
+		/**
+		 * @brief 复制[pos, pos + length)
+		 */
+		std::string Substring(size_t pos, size_t length) const
+		{
+			std::string result;
+			result.reserve(length);
+			ForEachPiece(pos, length, [&result](std::string_view piece)
+				{
+					result.append(piece.data(), piece.length());
+					return true;
+				});
+			return result;
+		}
+
+		std::string ToString() const
+		{
+			return Substring(0, GetLength());
+		}
+
+		/**
+		 * @brief 与text的公共前缀字节数，逐片段整块比较
+		 */
+		size_t CommonPrefixLength(std::string_view text) const
+		{
+			size_t matched = 0;
+			VisitRange(root.get(), 0, 0, GetLength(), [&](std::string_view piece)
+				{
+					const size_t length = _common_prefix_length(piece, text.substr(matched));
+					matched += length;
+					return length == piece.length();
+				});
+			return matched;
+		}
+
+		/**
+		 * @brief 与text的公共后缀字节数（最多limit个字节），逐片段从后向前整块比较
+		 */
+		size_t CommonSuffixLength(std::string_view text, size_t limit) const
+		{
+			limit = std::min({ limit, text.length(), GetLength() });
+			size_t matched = 0;
+			auto visit = [&](std::string_view piece)
+				{
+					if (matched + piece.length() > limit)
+						piece.remove_prefix(matched + piece.length() - limit);
+					const size_t length = _common_suffix_length(piece, text.substr(0, text.length() - matched));
+					matched += length;
+					return length == piece.length() && matched < limit;
+				};
+			VisitBackward(root.get(), visit);
+			return matched;
+		}
+
+		/**
+		 * @brief 应用字符级操作序列（位置基于应用前的文本，顺序规则与ApplyOperations相同）
+		 */
+		void Apply(const std::vector<StringOperation>& operations)
+		{
+			ApplyInReverse(operations);
+		}
+		void Apply(const std::vector<StringOperationRef>& operations)
+		{
+			ApplyInReverse(operations);
+		}
+
+		/**
+		 * @brief 应用行级操作序列（行号基于应用前的文本，与_extract_line_operations的输出口径相同）
+		 * 删除[start_line, end_line)时连同行尾换行符一起删除，删除到最后一行时改为删除前一行的换行符；
+		 * 在行前插入时每行带换行符，追加到末尾时换行符在各行之前
+		 */
+		void Apply(const std::vector<LineOperation>& operations)
+		{
+			const size_t line_count = GetLineCount();
+			const size_t length = GetLength();
+			std::vector<StringOperation> converted;
+			converted.reserve(operations.size());
+			bool cleared = false;  // 上一个操作删除了全部的行
+			for (const auto& op : operations)
+			{
+				if (op.start_line > line_count || (op.type == StringOpType::Delete && (op.end_line < op.start_line || op.end_line > line_count)))
+					throw std::invalid_argument("line operation is out of range");
+				if (op.type == StringOpType::Delete)
+				{
+					if (op.end_line == op.start_line)
+						continue;
+					size_t begin = GetLineStart(op.start_line);
+					size_t end = length;
+					if (op.end_line < line_count)
+						end = GetLineStart(op.end_line);
+					else if (begin > 0)
+						--begin;
+					cleared = op.start_line == 0 && op.end_line == line_count;
+					converted.emplace_back(StringOpType::Delete, begin, end, Substring(begin, end - begin));
+					continue;
+				}
+
+				std::string content;
+				if (op.start_line == line_count && !cleared)
+					content.push_back('\n');
+				for (size_t i = 0; i < op.lines.size(); ++i)
+				{
+					if (i > 0)
+						content.push_back('\n');
+					content += op.lines[i];
+				}
+				if (op.start_line < line_count)
+					content.push_back('\n');
+				const size_t pos = op.start_line < line_count ? GetLineStart(op.start_line) : length;
+				converted.emplace_back(StringOpType::Add, pos, pos, std::move(content));
+				cleared = false;
+			}
+			ApplyInReverse(converted);
+		}
+	};
+
+	/**
+	 * @brief 计算片段表到目标文本的差异操作序列
+	 * 公共的首尾行直接在片段上整块比较，只复制中间不同的部分再交给GetDiffOperationViews，
+	 * 操作位置基于片段表的当前文本
+	 * @param base 源文本
+	 * @param target 目标文本
+	 * @param options 差异算法选项（默认Myers）
+	 * @return 差异操作序列
+	 */
+	inline std::vector<StringOperation> GetDiffOperations(
+		const PieceTable& base,
+		std::string_view target,
+		const DiffOptions& options = DiffOptions())
+	{
+		// 与_trim_common_lines相同: 前缀退回到换行符之后，后缀推进到换行符之后；LCS算法不剥离
+		size_t prefix = 0, suffix = 0;
+		if (options.algorithm != DiffAlgorithm::LCS)
+		{
+			prefix = base.CommonPrefixLength(target);
+			const size_t last_newline = prefix == 0 ? std::string_view::npos : target.rfind('\n', prefix - 1);
+			prefix = last_newline == std::string_view::npos ? 0 : last_newline + 1;
+
+			const size_t common = base.CommonSuffixLength(target, std::min(base.GetLength(), target.length()) - prefix);
+			const size_t first_newline = target.find('\n', target.length() - common);
+			suffix = first_newline == std::string_view::npos ? 0 : target.length() - first_newline - 1;
+		}
+
+		const std::string middle = base.Substring(prefix, base.GetLength() - prefix - suffix);
+		const std::string_view target_middle = target.substr(prefix, target.length() - prefix - suffix);
+		std::vector<StringOperation> operations;
+		for (const auto& op : GetDiffOperationViews(middle, target_middle, options))
+			operations.emplace_back(op.type, prefix + op.start, prefix + op.end, std::string(op.content));
+		return operations;
 	}
 }
 
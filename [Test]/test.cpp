@@ -1,9 +1,1057 @@
 #include<Config.hpp>
+#include<String.hpp>
+#include<File.hpp>
 
 using namespace std;
 using namespace Convention;
 
+static int failures = 0;
+
+#define CHECK(expr)                                                              \
+    do                                                                           \
+    {                                                                            \
+        if (!(expr))                                                             \
+        {                                                                        \
+            ++failures;                                                          \
+            cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #expr ") failed\n"; \
+        }                                                                        \
+    } while (0)
+
+// 由alphabet中的字符组成的随机串，字母表越小公共子序列越多
+static string RandomText(mt19937& random, size_t length, const string& alphabet)
+{
+    string text(length, '\0');
+    for (auto& ch : text)
+        ch = alphabet[random() % alphabet.size()];
+    return text;
+}
+
+// 按指定内核填表后回溯得到的操作序列
+static vector<StringOperation> LCSTableOperations(const _CharLCSTable& table)
+{
+    vector<StringOperation> operations;
+    auto steps = _backtrack_lcs_path(table.s1, table.s2, [&table](size_t i, size_t j) { return table.Get(i, j); });
+    _replay_lcs_path(table.s1, table.s2, steps,
+        [&operations](StringOperationRef&& op) { operations.push_back(op.ToOperation()); });
+    return operations;
+}
+
+static bool SameOperations(const vector<StringOperation>& left, const vector<StringOperation>& right)
+{
+    if (left.size() != right.size())
+        return false;
+    for (size_t i = 0; i < left.size(); ++i)
+    {
+        if (left[i].type != right[i].type || left[i].start != right[i].start ||
+            left[i].end != right[i].end || left[i].content != right[i].content)
+            return false;
+    }
+    return true;
+}
+
+// 各SIMD内核与标量内核逐单元、逐操作一致（不支持的指令集会退回标量，比较仍然成立）
+static void TestLCSKernels()
+{
+    mt19937 random(4);
+    vector<pair<size_t, size_t>> sizes = { {0, 0}, {0, 7}, {9, 0}, {1, 1}, {3, 5}, {7, 9}, {8, 8}, {13, 31}, {33, 17}, {64, 65} };
+    for (int i = 0; i < 40; ++i)
+        sizes.emplace_back(random() % 200, random() % 200);
+    sizes.emplace_back(1500, 1300);
+
+    for (const auto& [m, n] : sizes)
+    {
+        for (const string alphabet : { "ab", "acgt", "abcdefghijklmnopqrstuvwxyz" })
+        {
+            const string s1 = RandomText(random, m, alphabet);
+            const string s2 = RandomText(random, n, alphabet);
+            _CharLCSTable scalar(s1, s2);
+            _fill_char_lcs_table(scalar, LCSKernel::Scalar);
+            const auto expected = LCSTableOperations(scalar);
+            for (LCSKernel kernel : { LCSKernel::SSE41, LCSKernel::AVX2, LCSKernel::Auto })
+            {
+                _CharLCSTable table(s1, s2);
+                _fill_char_lcs_table(table, kernel);
+                bool same_cells = true;
+                for (size_t i = 0; i <= m && same_cells; ++i)
+                    for (size_t j = 0; j <= n && same_cells; ++j)
+                        same_cells = table.Get(i, j) == scalar.Get(i, j);
+                CHECK(same_cells);
+                CHECK(SameOperations(LCSTableOperations(table), expected));
+            }
+        }
+    }
+}
+
+// 由vocabulary种行组成的随机文本，词汇少时重复行多；部分文本不以换行结尾
+static string RandomLines(mt19937& random, size_t count, size_t vocabulary)
+{
+    string text;
+    for (size_t i = 0; i < count; ++i)
+        text += "line " + to_string(random() % vocabulary) + "\n";
+    if (!text.empty() && random() % 3 == 0)
+        text.pop_back();
+    return text;
+}
+
+// 在text上随机插入、删除、修改edits处
+static string Mutate(mt19937& random, string text, size_t edits)
+{
+    for (size_t k = 0; k < edits; ++k)
+    {
+        const size_t pos = random() % (text.size() + 1);
+        switch (random() % 3)
+        {
+        case 0:
+            text.insert(pos, random() % 2 ? "new line\n" : "x");
+            break;
+        case 1:
+            if (pos < text.size())
+                text.erase(pos, 1 + random() % min<size_t>(12, text.size() - pos));
+            break;
+        default:
+            if (pos < text.size())
+                text[pos] = "abc\n"[random() % 4];
+            break;
+        }
+    }
+    return text;
+}
+
+// 差异测试用的文本对: 边界情况、相互修改得到的、完全无关的
+static vector<pair<string, string>> RandomTextPairs(mt19937& random, size_t count)
+{
+    vector<pair<string, string>> pairs = {
+        {"", ""}, {"", "a\nb\n"}, {"a\nb\n", ""}, {"same\n", "same\n"}, {"a", "b"}, {"a\n", "a"}, {"a", "a\n"} };
+    for (size_t i = 0; i < count; ++i)
+    {
+        string a = RandomLines(random, random() % 60, 2 + random() % 20);
+        string b = random() % 4 == 0
+            ? RandomLines(random, random() % 60, 2 + random() % 20)
+            : Mutate(random, a, random() % 8);
+        pairs.emplace_back(move(a), move(b));
+    }
+    return pairs;
+}
+
+static void TestDiffRoundTrip()
+{
+    mt19937 random(1);
+    for (const auto& [a, b] : RandomTextPairs(random, 400))
+    {
+        const auto operations = GetDiffOperations(a, b);
+        CHECK(ApplyOperations(a, operations) == b);
+        if (a == b)
+            CHECK(operations.empty());
+    }
+}
+
+// 朴素动态规划: 最长公共子序列长度
+static size_t NaiveLCSLength(const string& a, const string& b)
+{
+    vector<size_t> previous(b.size() + 1, 0), current(b.size() + 1, 0);
+    for (size_t i = 1; i <= a.size(); ++i)
+    {
+        for (size_t j = 1; j <= b.size(); ++j)
+            current[j] = a[i - 1] == b[j - 1] ? previous[j - 1] + 1 : max(previous[j], current[j - 1]);
+        swap(previous, current);
+    }
+    return previous[b.size()];
+}
+
+// 仅插入/删除的编辑距离
+static int NaiveEditorDistance(const string& a, const string& b)
+{
+    return static_cast<int>(a.size() + b.size() - 2 * NaiveLCSLength(a, b));
+}
+
+static void TestLinearSpaceEditorDistance()
+{
+    mt19937 random(2);
+    for (int i = 0; i < 300; ++i)
+    {
+        const string alphabet = i % 2 ? "ab" : "abcdefgh";
+        const string a = RandomText(random, random() % 150, alphabet);
+        const string b = RandomText(random, random() % 150, alphabet);
+        const int expected = NaiveEditorDistance(a, b);
+
+        const auto [distance, operations] = GetEditorDistanceAndOperationsLinearSpace(a, b, 1 + i % 4);
+        CHECK(distance == expected);
+        CHECK(ApplyOperations(a, operations) == b);
+
+        const auto [full_distance, full_operations] = GetEditorDistanceAndOperations(a, b);
+        CHECK(full_distance == expected);
+        CHECK(ApplyOperations(a, full_operations) == b);
+    }
+}
+
+// 允许替换的Levenshtein距离
+static int NaiveLevenshteinDistance(const string& a, const string& b)
+{
+    vector<int> previous(b.size() + 1), current(b.size() + 1);
+    for (size_t j = 0; j <= b.size(); ++j)
+        previous[j] = static_cast<int>(j);
+    for (size_t i = 1; i <= a.size(); ++i)
+    {
+        current[0] = static_cast<int>(i);
+        for (size_t j = 1; j <= b.size(); ++j)
+            current[j] = min({ previous[j] + 1, current[j - 1] + 1, previous[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1) });
+        swap(previous, current);
+    }
+    return previous[b.size()];
+}
+
+// 位并行内核覆盖单个机器字与跨多个64位块的模式串
+static void TestBitParallelDistances()
+{
+    mt19937 random(3);
+    for (int i = 0; i < 300; ++i)
+    {
+        const string alphabet = i % 2 ? "ab" : "abcdefgh";
+        const string a = RandomText(random, random() % 200, alphabet);
+        const string b = RandomText(random, random() % 200, alphabet);
+        const int editor = NaiveEditorDistance(a, b);
+        const int levenshtein = NaiveLevenshteinDistance(a, b);
+        CHECK(GetEditorDistance(a, b) == editor);
+        CHECK(GetLevenshteinDistance(a, b) == levenshtein);
+
+        const BitParallelPattern pattern(a);
+        CHECK(pattern.GetLCSLength(b) == NaiveLCSLength(a, b));
+        CHECK(pattern.GetEditorDistance(b) == editor);
+        CHECK(pattern.GetLevenshteinDistance(b) == levenshtein);
+    }
+}
+
+// 每种行级算法（含Histogram的不同出现次数上限）都能还原目标文本
+static void TestDiffAlgorithms()
+{
+    mt19937 random(5);
+    const auto pairs = RandomTextPairs(random, 300);
+    for (DiffAlgorithm algorithm : { DiffAlgorithm::Myers, DiffAlgorithm::LCS, DiffAlgorithm::Patience, DiffAlgorithm::Histogram })
+    {
+        for (size_t max_chain : { 0, 1, 2, 64 })
+        {
+            if (algorithm != DiffAlgorithm::Histogram && max_chain != 64)
+                continue;
+            DiffOptions options(algorithm);
+            options.histogram_max_chain = max_chain;
+            for (const auto& [a, b] : pairs)
+                CHECK(ApplyOperations(a, GetDiffOperations(a, b, options)) == b);
+        }
+    }
+}
+
+static vector<StringOperation> StreamingOperations(string_view a, string_view b, const DiffOptions& options)
+{
+    vector<StringOperation> operations;
+    GetDiffOperationsStreaming(a, b, [&operations](StringOperation&& op) { operations.push_back(move(op)); }, options);
+    return operations;
+}
+
+// 窗口很小时差异块会跨越多个窗口；细化规模超过上限时整块删除/添加
+static void TestStreamingDiff()
+{
+    mt19937 random(6);
+    const auto pairs = RandomTextPairs(random, 200);
+    for (size_t window : { 1, 2, 3, 16, 65536 })
+    {
+        for (size_t max_cells : { size_t(1), DiffOptions::default_char_table_max_cells })
+        {
+            DiffOptions options;
+            options.streaming_window_lines = window;
+            options.char_table_max_cells = max_cells;
+            for (const auto& [a, b] : pairs)
+                CHECK(ApplyOperations(a, StreamingOperations(a, b, options)) == b);
+        }
+    }
+
+    // 文本重载可以直接接受std::string与字符串字面量
+    CHECK(ApplyOperations("a\nb\n", StreamingOperations(string("a\nb\n"), string("a\nc\n"), DiffOptions())) == "a\nc\n");
+
+    const auto directory = filesystem::temp_directory_path();
+    const auto path1 = directory / "convention_test_stream_1.txt";
+    const auto path2 = directory / "convention_test_stream_2.txt";
+    const string a = RandomLines(random, 5000, 50);
+    const string b = Mutate(random, a, 40);
+    ofstream(path1, ios::binary) << a;
+    ofstream(path2, ios::binary) << b;
+    vector<StringOperation> operations;
+    GetFileDiffOperationsStreaming(ToolFile(path1), ToolFile(path2),
+        [&operations](StringOperation&& op) { operations.push_back(move(op)); });
+    CHECK(ApplyOperations(a, operations) == b);
+    filesystem::remove(path1);
+    filesystem::remove(path2);
+}
+
+// 行数足够多时才会按唯一公共行切分并行处理
+static void TestParallelDiff()
+{
+    mt19937 random(7);
+    for (int i = 0; i < 6; ++i)
+    {
+        string a;
+        for (size_t line = 0; line < 6000; ++line)
+            a += "unique " + to_string(line) + (random() % 4 == 0 ? " tail\n" : "\n");
+        const string b = Mutate(random, a, 20 + random() % 200);
+        for (size_t thread_count : { 0, 2, 4 })
+        {
+            for (DiffAlgorithm algorithm : { DiffAlgorithm::Myers, DiffAlgorithm::Patience, DiffAlgorithm::Histogram })
+            {
+                DiffOptions options(algorithm);
+                options.thread_count = thread_count;
+                CHECK(ApplyOperations(a, GetDiffOperations(a, b, options)) == b);
+            }
+        }
+    }
+}
+
+static bool SameOperations(const vector<StringOperationRef>& left, const vector<StringOperation>& right)
+{
+    return SameOperations(MaterializeOperations(left), right);
+}
+
+// 引用版本与复制版本逐个操作相同
+static void TestDiffOperationViews()
+{
+    mt19937 random(8);
+    for (const auto& [a, b] : RandomTextPairs(random, 300))
+    {
+        const auto views = GetDiffOperationViews(a, b);
+        CHECK(SameOperations(views, GetDiffOperations(a, b)));
+        CHECK(ApplyOperations(a, views) == b);
+    }
+}
+
+// 回调版本逐块输出的操作与一次性返回的数组相同
+static void TestDiffOperationsCallback()
+{
+    mt19937 random(9);
+    for (const auto& [a, b] : RandomTextPairs(random, 300))
+    {
+        for (size_t thread_count : { 1, 4 })
+        {
+            DiffOptions options;
+            options.thread_count = thread_count;
+            vector<StringOperation> operations;
+            GetDiffOperations(a, b, [&operations](StringOperation&& op) { operations.push_back(move(op)); }, options);
+            CHECK(SameOperations(operations, GetDiffOperations(a, b, options)));
+        }
+    }
+}
+
+static void TestApplyAndMerge3()
+{
+    CHECK(ApplyOperations("hello world", vector<StringOperation>{
+        { StringOpType::Delete, 0, 1, "h" }, { StringOpType::Add, 1, 1, "j" },
+        { StringOpType::Add, 11, 11, "!" } }) == "jello world!");
+
+    string base;
+    for (int line = 0; line < 20; ++line)
+        base += "line " + to_string(line) + "\n";
+    auto replace_line = [&base](int line, const string& text)
+        {
+            const string old_line = "line " + to_string(line) + "\n";
+            string result = base;
+            result.replace(result.find(old_line), old_line.size(), text);
+            return result;
+        };
+
+    // 两侧修改不同的行: 两处修改都被采用
+    const string ours = replace_line(3, "ours 3\n");
+    const string theirs = replace_line(15, "theirs 15\n");
+    const auto merged = Merge3(base, ours, theirs);
+    CHECK(!merged.HasConflicts());
+    string expected = ours;
+    expected.replace(expected.find("line 15\n"), 8, "theirs 15\n");
+    CHECK(merged.content == expected);
+
+    // 只有一侧修改或两侧相同时直接采用
+    CHECK(Merge3(base, base, theirs).content == theirs);
+    CHECK(Merge3(base, ours, base).content == ours);
+    CHECK(Merge3(base, ours, ours).content == ours);
+
+    // 两侧以不同内容修改同一行: 冲突标记块记录在conflicts中
+    const auto conflicted = Merge3(base, replace_line(5, "ours 5\n"), replace_line(5, "theirs 5\n"));
+    CHECK(conflicted.HasConflicts());
+    CHECK(conflicted.conflicts.size() == 1);
+    if (conflicted.conflicts.size() == 1)
+    {
+        const auto& conflict = conflicted.conflicts.front();
+        const string block = conflicted.content.substr(conflict.start, conflict.end - conflict.start);
+        CHECK(block.rfind("<<<<<<<", 0) == 0);
+        CHECK(block.find("ours 5\n") != string::npos);
+        CHECK(block.find("theirs 5\n") != string::npos);
+        CHECK(base.substr(conflict.base_start, conflict.base_end - conflict.base_start) == "line 5\n");
+    }
+
+    // 行首的纯插入不占用后面未修改的行
+    const auto inserted = Merge3("a\nb\nc\n", "a\nb\nX\nc\n", "a\nb\nY\nc\n");
+    CHECK(inserted.content == "a\nb\n<<<<<<< ours\nX\n=======\nY\n>>>>>>> theirs\nc\n");
+    CHECK(inserted.conflicts.size() == 1 && inserted.conflicts.front().base_start == 4 && inserted.conflicts.front().base_end == 4);
+    CHECK(Merge3("a\nb\nc\n", "a\nb\nX\nc\n", "a\nB\nc\n").content == "a\nB\nX\nc\n");
+    CHECK(Merge3("a\nb\nc\n", "X\na\nb\nc\n", "a\nb\nc\nY\n").content == "X\na\nb\nc\nY\n");
+    CHECK(Merge3("a\nb\nc\n", "a\nX\nb\nc\n", "a\nX\nb\nc\nZ\n").content == "a\nX\nb\nc\nZ\n");
+}
+
+static void TestEncodedDelta()
+{
+    mt19937 random(11);
+    for (const auto& [a, b] : RandomTextPairs(random, 300))
+    {
+        const auto operations = GetDiffOperations(a, b);
+        const auto encoded = EncodeOperations(operations, a.size());
+        CHECK(ApplyEncodedDelta(a, encoded) == b);
+        CHECK(ApplyOperations(a, DecodeOperations(encoded, a)) == b);
+    }
+    CHECK(ApplyEncodedDelta("", EncodeOperations({}, 0)) == "");
+    CHECK(ApplyEncodedDelta("same", EncodeOperations({}, 4)) == "same");
+}
+
+static void TestPreparedDiffBase()
+{
+    mt19937 random(12);
+    const string base = RandomLines(random, 200, 40);
+    const PreparedDiffBase prepared(base);
+    CHECK(prepared.GetBase() == base);
+    for (int round = 0; round < 100; ++round)
+    {
+        const string variant = Mutate(random, base, 1 + random() % 20);
+        for (DiffAlgorithm algorithm : { DiffAlgorithm::Myers, DiffAlgorithm::LCS, DiffAlgorithm::Patience, DiffAlgorithm::Histogram })
+        {
+            const DiffOptions options(algorithm);
+            const auto operations = prepared.GetDiffOperations(variant, options);
+            CHECK(SameOperations(operations, GetDiffOperations(base, variant, options)));
+            CHECK(SameOperations(prepared.GetDiffOperationViews(variant, options), operations));
+            CHECK(ApplyOperations(base, operations) == variant);
+        }
+    }
+    CHECK(prepared.GetDiffOperations(base).empty());
+    CHECK(ApplyOperations(base, prepared.GetDiffOperations("")) == "");
+}
+
+static void TestDiffOperationsBatch()
+{
+    mt19937 random(13);
+    const string base = RandomLines(random, 150, 30);
+    vector<string> variants;
+    for (int index = 0; index < 40; ++index)
+        variants.push_back(Mutate(random, base, random() % 15));
+    variants.push_back("");
+    variants.push_back(base);
+    for (size_t thread_count : { 1, 3, 0 })
+    {
+        const auto results = GetDiffOperationsBatch(base, variants, DiffOptions(), thread_count);
+        CHECK(results.size() == variants.size());
+        for (size_t index = 0; index < variants.size() && index < results.size(); ++index)
+        {
+            CHECK(SameOperations(results[index], GetDiffOperations(base, variants[index])));
+            CHECK(ApplyOperations(base, results[index]) == variants[index]);
+        }
+    }
+}
+
+static void TestCommonAffixTrimming()
+{
+    mt19937 random(14);
+    for (int round = 0; round < 500; ++round)
+    {
+        const string a = RandomText(random, random() % 80, "ab");
+        string b = a;
+        if (!b.empty())
+            b[random() % b.size()] ^= 1;
+        b += RandomText(random, random() % 3, "ab");
+        size_t prefix = 0;
+        while (prefix < a.size() && prefix < b.size() && a[prefix] == b[prefix])
+            ++prefix;
+        size_t suffix = 0;
+        while (suffix < a.size() && suffix < b.size() && a[a.size() - 1 - suffix] == b[b.size() - 1 - suffix])
+            ++suffix;
+        CHECK(_common_prefix_length(a, b) == prefix);
+        CHECK(_common_suffix_length(a, b) == suffix);
+    }
+
+    // 大段公共首尾只包围一处很小的修改
+    const string head = RandomLines(random, 3000, 50), tail = RandomLines(random, 3000, 50);
+    const string a = head + "old middle\n" + tail, b = head + "new middle line\n" + tail;
+    const auto operations = GetDiffOperations(a, b);
+    CHECK(ApplyOperations(a, operations) == b);
+    for (const auto& op : operations)
+        CHECK(op.start >= head.size() && op.end <= a.size() - tail.size());
+    CHECK(ApplyOperations(a.substr(head.size(), 11), _char_diff_in_region(a.substr(head.size(), 11), b.substr(head.size(), 16))) == b.substr(head.size(), 16));
+}
+
+static void TestBoundedEditorDistance()
+{
+    mt19937 random(15);
+    for (int round = 0; round < 400; ++round)
+    {
+        const string a = RandomText(random, random() % 40, "abc");
+        const string b = random() % 2 ? Mutate(random, a, random() % 6) : RandomText(random, random() % 40, "abc");
+        const int distance = NaiveEditorDistance(a, b);
+        for (int k : { 0, 1, 3, 8, 100 })
+        {
+            CHECK(GetEditorDistanceBounded(a, b, k) == min(distance, k + 1));
+            const auto bounded = GetEditorDistanceAndOperationsBounded(a, b, k);
+            CHECK(bounded.has_value() == (distance <= k));
+            if (bounded)
+            {
+                CHECK(bounded->first == distance);
+                CHECK(ApplyOperations(a, bounded->second) == b);
+            }
+        }
+    }
+    bool thrown = false;
+    try { GetEditorDistanceBounded("a", "b", -1); }
+    catch (const invalid_argument&) { thrown = true; }
+    CHECK(thrown);
+}
+
+static void TestFuzzyStringIndex()
+{
+    mt19937 random(16);
+    vector<string> keys;
+    for (int index = 0; index < 300; ++index)
+        keys.push_back(RandomText(random, random() % 12, "abcd"));
+    keys.push_back(keys.front());
+    for (size_t q : { 1, 2, 3 })
+    {
+        const FuzzyStringIndex index(keys, q, 2);
+        CHECK(index.GetKeyCount() == keys.size());
+        for (int round = 0; round < 60; ++round)
+        {
+            const string query = RandomText(random, random() % 12, "abcd");
+            for (int k : { 0, 1, 2, 4 })
+            {
+                vector<pair<int, size_t>> expected;
+                for (size_t key = 0; key < keys.size(); ++key)
+                {
+                    const int distance = NaiveEditorDistance(keys[key], query);
+                    if (distance <= k)
+                        expected.emplace_back(distance, key);
+                }
+                sort(expected.begin(), expected.end());
+                const auto matches = index.Find(query, k);
+                CHECK(matches.size() == expected.size());
+                for (size_t i = 0; i < matches.size() && i < expected.size(); ++i)
+                    CHECK(matches[i].distance == expected[i].first && matches[i].index == expected[i].second);
+            }
+        }
+    }
+}
+
+static string RandomUTF8(mt19937& random, size_t length)
+{
+    static const vector<string> characters = { "a", "b", "\n", "\xC3\xA9", "\xC3\xA8", "\xE4\xB8\xAD", "\xE6\x96\x87", "\xF0\x9F\x98\x80", "\xF0\x9F\x98\x81" };
+    string text;
+    for (size_t i = 0; i < length; ++i)
+        text += characters[random() % characters.size()];
+    return text;
+}
+
+static void TestUTF8Diff()
+{
+    mt19937 random(17);
+    vector<uint32_t> codepoints;
+    vector<size_t> offsets;
+    CHECK(_decode_utf8("a\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80", codepoints, offsets));
+    CHECK(codepoints == vector<uint32_t>({ 0x61, 0xE9, 0x4E2D, 0x1F600 }));
+    CHECK(offsets == vector<size_t>({ 0, 1, 3, 6, 10 }));
+    for (const char* invalid : { "\x80", "\xC3", "\xC0\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80" })
+        CHECK(!_decode_utf8(invalid, codepoints, offsets));
+
+    DiffOptions options;
+    options.utf8 = true;
+    for (int round = 0; round < 300; ++round)
+    {
+        const string a = RandomUTF8(random, random() % 60);
+        const string b = RandomUTF8(random, random() % 60);
+        const auto operations = GetDiffOperations(a, b, options);
+        CHECK(ApplyOperations(a, operations) == b);
+        for (const auto& op : operations)
+            CHECK(_decode_utf8(op.content, codepoints, offsets));
+    }
+
+    // 非法的UTF-8按字节比较，结果仍然正确
+    const string a = "ab\xFF\xC3\n", b = "a\xC3\xA9\xFF\n";
+    CHECK(ApplyOperations(a, GetDiffOperations(a, b, options)) == b);
+}
+
+static void TestTokenizedDiff()
+{
+    mt19937 random(18);
+    DiffOptions options;
+    options.custom_tokenizer = [](string_view text, size_t pos) { return text[pos] == ',' ? size_t(1) : min<size_t>(3, text.length() - pos); };
+    for (DiffTokenizer tokenizer : { DiffTokenizer::Whitespace, DiffTokenizer::Identifier, DiffTokenizer::Custom })
+    {
+        options.tokenizer = tokenizer;
+        for (int round = 0; round < 200; ++round)
+        {
+            const string a = RandomText(random, random() % 60, "ab _,.\n");
+            const string b = random() % 2 ? Mutate(random, a, random() % 5) : RandomText(random, random() % 60, "ab _,.\n");
+            CHECK(ApplyOperations(a, GetDiffOperations(a, b, options)) == b);
+        }
+    }
+
+    // 行内修改以整词为单位
+    options.tokenizer = DiffTokenizer::Whitespace;
+    const auto operations = GetDiffOperations("hello world\n", "hello there\n", options);
+    CHECK(operations.size() == 2);
+    for (const auto& op : operations)
+        CHECK(op.content == "world" || op.content == "there");
+
+    options.tokenizer = DiffTokenizer::Identifier;
+    CHECK(ApplyOperations("f(alpha, beta)\n", GetDiffOperations("f(alpha, beta)\n", "f(alpha, gamma)\n", options)) == "f(alpha, gamma)\n");
+    for (const auto& op : GetDiffOperations("f(alpha, beta)\n", "f(alpha, gamma)\n", options))
+        CHECK(op.content == "beta" || op.content == "gamma");
+
+    options.tokenizer = DiffTokenizer::Custom;
+    options.custom_tokenizer = nullptr;
+    bool thrown = false;
+    try { GetDiffOperations("a\n", "b\n", options); }
+    catch (const invalid_argument&) { thrown = true; }
+    CHECK(thrown);
+}
+
+static void TestBinaryDelta()
+{
+    mt19937 random(19);
+    auto random_bytes = [&random](size_t length)
+        {
+            vector<uint8_t> bytes(length);
+            for (auto& byte : bytes)
+                byte = static_cast<uint8_t>(random());
+            return bytes;
+        };
+    for (size_t block_size : { 1, 4, 16, 64 })
+    {
+        for (int round = 0; round < 50; ++round)
+        {
+            const auto base = random_bytes(random() % 2000);
+            vector<uint8_t> target = base;
+            // 块的移动、重复、插入与删除
+            for (int edit = random() % 6; edit > 0 && !target.empty(); --edit)
+            {
+                const size_t at = random() % target.size(), length = min<size_t>(random() % 200, target.size() - at);
+                const vector<uint8_t> block(target.begin() + at, target.begin() + at + length);
+                switch (random() % 3)
+                {
+                case 0: target.erase(target.begin() + at, target.begin() + at + length); break;
+                case 1: target.insert(target.begin() + random() % (target.size() + 1), block.begin(), block.end()); break;
+                default: { const auto noise = random_bytes(random() % 20); target.insert(target.begin() + at, noise.begin(), noise.end()); } break;
+                }
+            }
+            CHECK(ApplyBinaryDelta(base, CreateBinaryDelta(base, target, block_size)) == target);
+        }
+    }
+
+    const vector<uint8_t> empty, data = random_bytes(5000);
+    CHECK(ApplyBinaryDelta(empty, CreateBinaryDelta(empty, empty)) == empty);
+    CHECK(ApplyBinaryDelta(empty, CreateBinaryDelta(empty, data)) == data);
+    CHECK(ApplyBinaryDelta(data, CreateBinaryDelta(data, empty)) == empty);
+
+    // 前后两半交换: 差异只包含两次复制
+    vector<uint8_t> swapped(data.begin() + 2500, data.end());
+    swapped.insert(swapped.end(), data.begin(), data.begin() + 2500);
+    const auto delta = CreateBinaryDelta(data, swapped);
+    CHECK(delta.size() < 64);
+    CHECK(ApplyBinaryDelta(data, delta) == swapped);
+    CHECK(ApplyEncodedDelta(string_view(reinterpret_cast<const char*>(data.data()), data.size()), delta)
+        == string(swapped.begin(), swapped.end()));
+
+    bool thrown = false;
+    try { CreateBinaryDelta(data, swapped, 0); }
+    catch (const invalid_argument&) { thrown = true; }
+    CHECK(thrown);
+}
+
+static void TestPieceTable()
+{
+    mt19937 random(20);
+    for (int round = 0; round < 20; ++round)
+    {
+        string reference = RandomText(random, random() % 200, "ab\n");
+        PieceTable table(reference);
+        for (int edit = 0; edit < 300; ++edit)
+        {
+            const size_t pos = random() % (reference.size() + 1);
+            if (random() % 2)
+            {
+                const string text = RandomText(random, random() % 10, "cd\n");
+                table.Insert(pos, text);
+                reference.insert(pos, text);
+            }
+            else
+            {
+                const size_t length = random() % (reference.size() - pos + 1);
+                table.Erase(pos, length);
+                reference.erase(pos, length);
+            }
+            CHECK(table.GetLength() == reference.size());
+        }
+        CHECK(table.ToString() == reference);
+
+        // 行查询与子串
+        const size_t line_count = count(reference.begin(), reference.end(), '\n') + 1;
+        CHECK(table.GetLineCount() == line_count);
+        for (size_t line = 0, start = 0; line < line_count; start = reference.find('\n', start) + 1, ++line)
+            CHECK(table.GetLineStart(line) == start);
+        for (size_t pos = 0; pos <= reference.size(); ++pos)
+            CHECK(table.GetLineOfOffset(pos) == size_t(count(reference.begin(), reference.begin() + pos, '\n')));
+        const size_t pos = random() % (reference.size() + 1), length = random() % (reference.size() - pos + 1);
+        CHECK(table.Substring(pos, length) == reference.substr(pos, length));
+
+        // 差异操作可以直接应用到片段表
+        const string target = Mutate(random, reference, 1 + random() % 8);
+        const auto operations = GetDiffOperations(table, target);
+        CHECK(ApplyOperations(reference, operations) == target);
+        table.Apply(operations);
+        CHECK(table.ToString() == target);
+        table.Apply(GetDiffOperationViews(target, reference));
+        CHECK(table.ToString() == reference);
+    }
+
+    // 行级操作: 有无结尾换行、删除全部后再追加
+    const vector<pair<string, string>> line_cases = {
+        { "a\nb\nc\n", "a\nc\nd\n" }, { "a\nb\nc", "a\nc\nd" }, { "a\nb", "a\nb\nc" }, { "a\nb\n", "a\nb\n\nc" },
+        { "a\nb\nc", "a" }, { "a\nb\nc\n", "" }, { "a\nb", "" }, { "", "x\ny" }, { "a\nb", "c\nd" },
+        { "a\nb\n", "c\nd\n" }, { "a", "b\n" }, { "x\na\nb", "a\nb" }, { "a\nb", "x\na\nb" },
+    };
+    vector<pair<string, string>> line_pairs = line_cases;
+    for (int round = 0; round < 200; ++round)
+    {
+        string a = RandomLines(random, random() % 12, 5), b = RandomLines(random, random() % 12, 5);
+        if (random() % 2 && !a.empty())
+            a.pop_back();
+        if (random() % 2 && !b.empty())
+            b.pop_back();
+        line_pairs.emplace_back(a, b);
+    }
+    for (const auto& [a, b] : line_pairs)
+    {
+        const auto lines1 = _split_lines(a), lines2 = _split_lines(b);
+        PieceTable from_table(a), from_matches(a);
+        from_table.Apply(_extract_line_operations(lines1, lines2, _build_line_lcs(lines1, lines2)));
+        from_matches.Apply(_extract_line_operations(lines1, lines2, _build_line_matches(lines1, lines2)));
+        CHECK(from_table.ToString() == b);
+        CHECK(from_matches.ToString() == b);
+    }
+
+    PieceTable table("abc");
+    bool thrown = false;
+    try { table.Insert(4, "x"); }
+    catch (const out_of_range&) { thrown = true; }
+    CHECK(thrown);
+    thrown = false;
+    try { table.Erase(2, 2); }
+    catch (const out_of_range&) { thrown = true; }
+    CHECK(thrown);
+    thrown = false;
+    try { table.GetLineStart(1); }
+    catch (const out_of_range&) { thrown = true; }
+    CHECK(thrown);
+}
+
+static void TestBytesAndByteChain()
+{
+    const vector<vector<uint8_t>> lines = { { 'a', 'b' }, {}, { 0, 0xFF, '\n' }, { 'z' } };
+    const string joined("ab\0\xFF\nz", 6);
+    CHECK(Bytes2String(lines) == joined);
+    CHECK(Bytes2Strings(lines) == vector<string>({ "ab", "", string("\0\xFF\n", 3), "z" }));
+    const vector<pair<const char*, size_t>> pieces = { { joined.data(), 2 }, { joined.data() + 2, 3 }, { joined.data() + 5, 1 } };
+    CHECK(Bytes2String(pieces) == joined);
+    CHECK(Bytes2Strings(pieces) == vector<string>({ "ab", string("\0\xFF\n", 3), "z" }));
+    CHECK(Bytes2String(vector<vector<uint8_t>>()).empty());
+
+    ByteChain chain;
+    const string header = "header:";
+    chain.Append(header).Append(lines[2]).Append(lines[1]).Append("tail", 4);
+    CHECK(chain.GetSize() == 14);
+    CHECK(chain.GetSegments().size() == 3);
+    const auto flattened = chain.Flatten();
+    CHECK(string(flattened.begin(), flattened.end()) == header + string("\0\xFF\n", 3) + "tail");
+
+    // 分散写出后读回的内容与拼接结果一致
+    const auto directory = filesystem::temp_directory_path() / ("convention_test_" + to_string(random_device()()));
+    ToolFile file(directory / "chain.bin");
+    file.SaveAsBinary(chain);
+    CHECK(file.LoadAsBinary() == flattened);
+    CHECK(file.MapAsReadOnly().GetView() == string_view(reinterpret_cast<const char*>(flattened.data()), flattened.size()));
+    file.SaveAsBinary(ByteChain());
+    CHECK(file.LoadAsBinary().empty());
+    CHECK(file.MapAsReadOnly().GetSize() == 0);
+    filesystem::remove_all(directory);
+}
+
+template<typename DataType>
+static void CheckFillAndLimit(const DataType& data)
+{
+    for (size_t max_length : { 0, 1, 5, 18, 19, 30, 64 })
+    {
+        for (const char* side : { "left", "right", "center" })
+        {
+            const string expected = FillString(data, max_length, '*', side);
+            string appended = "prefix";
+            AppendFillString(appended, data, max_length, '*', side);
+            CHECK(appended == "prefix" + expected);
+            string written(GetFillStringLength(data, max_length), '\0');
+            CHECK(FillStringTo(written.begin(), data, max_length, '*', side) == written.end());
+            CHECK(written == expected);
+        }
+
+        // 旧版在max_length小于省略号长度时会越界，只比较两者都有定义的范围
+        string limited;
+        AppendLimitStringLength(limited, data, max_length);
+        CHECK(limited.size() == GetLimitStringLength(data, max_length));
+        string written(GetLimitStringLength(data, max_length), '\0');
+        CHECK(LimitStringLengthTo(written.begin(), data, max_length) == written.end());
+        CHECK(written == limited);
+        if (max_length >= 18)
+            CHECK(limited == LimitStringLength(data, max_length));
+    }
+}
+
+static void TestFillAndLimitWriters()
+{
+    CheckFillAndLimit(string("short"));
+    CheckFillAndLimit(string(100, 'x') + "tail");
+    CheckFillAndLimit("0123456789012345678901234567890123456789");
+    CheckFillAndLimit(12345);
+    CheckFillAndLimit(-9876543210LL);
+    CheckFillAndLimit(3.25);
+    CheckFillAndLimit(-1e30);
+    CheckFillAndLimit(1.5f);
+
+    bool thrown = false;
+    try { string output; AppendFillString(output, "x", 5, ' ', "middle"); }
+    catch (const invalid_argument&) { thrown = true; }
+    CHECK(thrown);
+
+    const vector<vector<string>> rows = { { "name", "value" }, { "a", "12345", "extra" }, {}, { "longer name" } };
+    for (const char* side : { "left", "right", "center" })
+    {
+        vector<size_t> widths(3, 0);
+        for (const auto& row : rows)
+            for (size_t c = 0; c < row.size(); ++c)
+                widths[c] = max(widths[c], row[c].size());
+        string expected;
+        for (const auto& row : rows)
+        {
+            for (size_t c = 0; c < row.size(); ++c)
+                expected += (c == 0 ? "" : " | ") + FillString(row[c], widths[c], '.', side);
+            expected += '\n';
+        }
+        CHECK(FormatTable(rows, " | ", '.', side) == expected);
+    }
+    CHECK(FormatTable(vector<vector<int>>{ { 1, 100 }, { 10, 2 } }) == " 1 100\n10   2\n");
+}
+
+struct FormatPoint
+{
+    int x, y;
+    string ToString() const { return "(" + to_string(x) + ", " + to_string(y) + ")"; }
+};
+
+static void TestMakeFormat()
+{
+    CHECK(make_format("no arguments") == "no arguments");
+    CHECK(make_format("") == "");
+    CHECK(make_format("{}", 42) == "42");
+    CHECK(make_format("x = {}, y = {}", -7, string("text")) == "x = -7, y = text");
+    CHECK(make_format("{}{}{}", 'a', true, false) == "atruefalse");
+    CHECK(make_format("{{{}}} {{}}", "v") == "{v} {}");
+    CHECK(make_format("{} and {}", string_view("view"), FormatPoint{ 1, 2 }) == "view and (1, 2)");
+    CHECK(make_format("{}", uint64_t(18446744073709551615ull)) == "18446744073709551615");
+    CHECK(make_format("{}", 0.1) == "0.1");
+    CHECK(make_format("{}", 1.5f) == "1.5");
+
+    // 浮点数输出最短且能读回原值的文本
+    mt19937_64 random(23);
+    for (int round = 0; round < 1000; ++round)
+    {
+        uint64_t bits = random();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (!isfinite(value))
+            continue;
+        CHECK(strtod(make_format("{}", value).c_str(), nullptr) == value);
+    }
+
+    // 超出栈上缓冲区后转到堆上
+    const string long_text(1000, 'q');
+    CHECK(make_format("[{}|{}]", long_text, long_text) == "[" + long_text + "|" + long_text + "]");
+
+    string output = "head:";
+    make_format_to(output, "{}-{}", 1, 2);
+    make_format_to(output, ";");
+    CHECK(output == "head:1-2;");
+    FormatBuffer buffer;
+    for (int i = 0; i < 100; ++i)
+        make_format_to(buffer, "{},", i);
+    string expected;
+    for (int i = 0; i < 100; ++i)
+        expected += to_string(i) + ",";
+    CHECK(buffer.ToString() == expected);
+    CHECK(buffer.GetView() == expected);
+}
+
+static void TestNumberParsing()
+{
+    int integer = 0;
+    CHECK(StringIndicator::TryToValue("12345", integer) == errc() && integer == 12345);
+    CHECK(StringIndicator::TryToValue("-42", integer) == errc() && integer == -42);
+    CHECK(StringIndicator::TryToValue("+7", integer) == errc() && integer == 7);
+    for (const char* invalid : { "", "+", "+-5", "12a", " 1", "1 ", "0x10", "--1" })
+        CHECK(StringIndicator::TryToValue(invalid, integer) == errc::invalid_argument);
+    uint8_t byte = 0;
+    CHECK(StringIndicator::TryToValue("255", byte) == errc() && byte == 255);
+    CHECK(StringIndicator::TryToValue("256", byte) == errc::result_out_of_range);
+    CHECK(StringIndicator::TryToValue("-1", byte) == errc::invalid_argument);
+    int64_t wide = 0;
+    CHECK(StringIndicator::TryToValue("-9223372036854775808", wide) == errc() && wide == numeric_limits<int64_t>::min());
+    CHECK(StringIndicator::TryToValue("9223372036854775808", wide) == errc::result_out_of_range);
+    bool flag = false;
+    CHECK(StringIndicator::TryToValue("true", flag) == errc() && flag);
+    CHECK(StringIndicator::TryToValue("false", flag) == errc() && !flag);
+    CHECK(StringIndicator::TryToValue("1", flag) == errc::invalid_argument);
+    double real = 0;
+    CHECK(StringIndicator::TryToValue("2.5e-3", real) == errc() && real == 2.5e-3);
+    CHECK(StringIndicator::TryToValue("+0.125", real) == errc() && real == 0.125);
+    CHECK(StringIndicator::TryToValue("1e999", real) == errc::result_out_of_range);
+    CHECK(StringIndicator::TryToValue("1.5.2", real) == errc::invalid_argument);
+
+    // 跨越多个分块的长列与参考解析逐项比较
+    mt19937_64 random(24);
+    string text;
+    vector<int64_t> expected;
+    while (text.size() < 300000)
+    {
+        const int64_t value = static_cast<int64_t>(random()) >> (random() % 64);
+        expected.push_back(value);
+        text += (random() % 4 == 0 ? " " : "") + to_string(value) + (random() % 4 == 0 ? "\r\n" : "\n");
+    }
+    vector<int64_t> values;
+    auto result = ParseNumberColumn(text, values);
+    CHECK(result.ec == errc() && result.field == expected.size());
+    CHECK(values == expected);
+
+    vector<double> reals;
+    result = ParseNumberColumn("1.5, -2 ,3e2", reals, ',');
+    CHECK(result.ec == errc() && reals == vector<double>({ 1.5, -2, 300 }));
+
+    // 出错时指明字段，保留之前已解析的值
+    values.clear();
+    result = ParseNumberColumn("1\n2\nx3\n4\n", values);
+    CHECK(result.ec == errc::invalid_argument && result.field == 2 && result.offset == 4);
+    CHECK(values == vector<int64_t>({ 1, 2 }));
+    values.clear();
+    result = ParseNumberColumn("1\n\n2", values);
+    CHECK(result.ec == errc::invalid_argument && result.field == 1 && result.offset == 2);
+    values.clear();
+    CHECK(ParseNumberColumn("", values).field == 0 && values.empty());
+}
+
+static void TestCombineReserved()
+{
+    const auto reference = [](const auto&... args) { return (string() + ... + StringIndicator::ToString<string>(args)); };
+    const string long_text(300, 'L');
+    CHECK(StringIndicator::CombineReserved() == "");
+    CHECK(StringIndicator::CombineReserved("a", string("b"), string_view("c")) == "abc");
+    CHECK(StringIndicator::CombineReserved(-12, 34u, int64_t(-9223372036854775807LL - 1), uint64_t(18446744073709551615ull))
+        == reference(-12, 34u, int64_t(-9223372036854775807LL - 1), uint64_t(18446744073709551615ull)));
+    CHECK(StringIndicator::CombineReserved(short(-5), (unsigned char)200, true) == reference(short(-5), (unsigned char)200, true));
+    // 浮点文本超出预留长度时扩展
+    CHECK(StringIndicator::CombineReserved(1.5, -0.25f, 1e300, 3.0L) == reference(1.5, -0.25f, 1e300, 3.0L));
+    CHECK(StringIndicator::CombineReserved(long_text, 7, FormatPoint{ 3, 4 }, long_text) == reference(long_text, 7, FormatPoint{ 3, 4 }, long_text));
+    CHECK(StringIndicator::CombineReserved(FormatPoint{ 5, 6 }) == "(5, 6)");
+
+    CHECK(StringIndicator::Combine<string>(1) == "1");
+    CHECK(StringIndicator::Combine<string>("x", 2) == "x2");
+    CHECK(StringIndicator::Combine<string>("x=", 2.5, ", y=", -3, long_text) == reference("x=", 2.5, ", y=", -3, long_text));
+}
+
+// 完全改写的大差异块超过细化上限时整块替换，时间与长度成线性
+static void TestLargeRewrittenHunk()
+{
+    mt19937 random(606);
+    string a, b;
+    for (int line = 0; line < 1100; ++line)
+    {
+        a += RandomText(random, 1000, "abc ") + "\n";
+        b += RandomText(random, 1000, "xyz ") + "\n";
+    }
+    CHECK(a.size() >= (1 << 20) && b.size() >= (1 << 20));
+
+    DiffOptions utf8, words, parallel;
+    utf8.utf8 = true;
+    words.tokenizer = DiffTokenizer::Whitespace;
+    parallel.thread_count = 8;
+    for (const DiffOptions& options : { DiffOptions(), utf8, words, parallel })
+    {
+        const auto begin = chrono::steady_clock::now();
+        const auto operations = GetDiffOperations(a, b, options);
+        const auto streamed = StreamingOperations(a, b, options);
+        CHECK(chrono::steady_clock::now() - begin < chrono::seconds(5));
+        CHECK(operations.size() == 2);
+        CHECK(ApplyOperations(a, operations) == b);
+        CHECK(ApplyOperations(a, streamed) == b);
+    }
+}
+
+// 低熵数据中所有块的校验和相同，复制应接续上一段而不是跳到base末尾
+static void TestLowEntropyBinaryDelta()
+{
+    for (int period : { 1, 8 })
+    {
+        vector<uint8_t> base(4 << 20);
+        for (size_t i = 0; i < base.size(); ++i)
+            base[i] = static_cast<uint8_t>(period == 1 ? 0 : i % period * 37);
+        vector<uint8_t> target = base;
+        target[1000000] ^= 0xFF;
+        const uint8_t inserted[] = { 1, 2, 3, 4, 5 };
+        target.insert(target.begin() + 3000000, begin(inserted), end(inserted));
+        for (size_t block_size : { 16, 64 })
+        {
+            const auto delta = CreateBinaryDelta(base, target, block_size);
+            CHECK(delta.size() < 64);
+            CHECK(ApplyBinaryDelta(base, delta) == target);
+        }
+    }
+}
+
 int main()
 {
+    TestLCSKernels();
+    TestDiffRoundTrip();
+    TestLinearSpaceEditorDistance();
+    TestBitParallelDistances();
+    TestDiffAlgorithms();
+    TestStreamingDiff();
+    TestParallelDiff();
+    TestDiffOperationViews();
+    TestDiffOperationsCallback();
+    TestApplyAndMerge3();
+    TestEncodedDelta();
+    TestPreparedDiffBase();
+    TestDiffOperationsBatch();
+    TestCommonAffixTrimming();
+    TestBoundedEditorDistance();
+    TestFuzzyStringIndex();
+    TestUTF8Diff();
+    TestTokenizedDiff();
+    TestBinaryDelta();
+    TestPieceTable();
+    TestBytesAndByteChain();
+    TestFillAndLimitWriters();
+    TestMakeFormat();
+    TestNumberParsing();
+    TestCombineReserved();
+    TestLargeRewrittenHunk();
+    TestLowEntropyBinaryDelta();
 
+    if (failures != 0)
+    {
+        cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    cout << "all tests passed\n";
+    return 0;
 }